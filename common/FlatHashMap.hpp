@@ -0,0 +1,490 @@
+#pragma once
+
+/*
+
+FlatHashMap: open-addressing hash map in the style of Swiss tables (Abseil flat_hash_map), written as a benchmark contender
+for std::unordered_map: same hashing, but no per-element node allocation.
+
+Layout and probing:
+    -Slots are stored in a single flat array; for every slot there is one control byte telling whether the slot is
+     empty, deleted or full. For full slots, the control byte holds 7 bits of the hash (H2).
+    -Slots are probed in groups of 16: the control bytes of a group are compared against H2 with one SIMD comparison
+     (SSE2, scalar fallback on other targets) and only slots whose control byte matches are compared by key.
+    -Group sequence is quadratic (triangular) starting from the group given by the remaining hash bits (H1). Capacity is
+     a power of two and multiple of the group size, so the probe sequence visits every group.
+    -Maximum load factor is 7/8.
+
+Interface is the subset of std::unordered_map used by the benchmarks: insert(), operator[], find(), erase(key), reserve(),
+size(), clear() and iteration. In addition findBatch() looks up many keys at once: hashes of up to batchSize keys are computed
+and their control groups prefetched first, then the matching slots are prefetched and only then the keys are compared,
+so that cache misses of different keys overlap instead of each lookup waiting for its own. Differences to std::unordered_map:
+    -value_type is std::pair<Key_T, Val_T> (key not const) as elements are moved on rehash; modifying key through
+     iterator is not allowed.
+    -Iterators and references are invalidated by every insert that rehashes the table.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define BENCH_FLAT_HASH_MAP_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define BENCH_FLAT_HASH_MAP_SSE2 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace bench
+{
+
+template <class Key_T, class Val_T, class Hash_T = std::hash<Key_T>, class KeyEqual_T = std::equal_to<Key_T>>
+class FlatHashMap
+{
+public:
+    using key_type = Key_T;
+    using mapped_type = Val_T;
+    using value_type = std::pair<Key_T, Val_T>;
+    using size_type = size_t;
+    using hasher = Hash_T;
+    using key_equal = KeyEqual_T;
+
+    static constexpr size_t groupSize = 16;
+
+private:
+    enum : std::int8_t
+    {
+        ctrlEmpty = -128,   // 0b10000000
+        ctrlDeleted = -2    // 0b11111110
+        // Full: 0b0xxxxxxx where xxxxxxx is H2.
+    };
+
+    // Bit mask of slots in group, bit i corresponding to slot i.
+    class GroupMask
+    {
+    public:
+        explicit GroupMask(const unsigned int nMask) : m_nMask(nMask) {}
+        explicit operator bool() const { return m_nMask != 0; }
+        unsigned int lowestIndex() const
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long nIndex;
+            _BitScanForward(&nIndex, m_nMask);
+            return static_cast<unsigned int>(nIndex);
+#else
+            return static_cast<unsigned int>(__builtin_ctz(m_nMask));
+#endif
+        }
+        void removeLowest() { m_nMask &= (m_nMask - 1); }
+
+        unsigned int m_nMask;
+    };
+
+    static GroupMask matchByte(const std::int8_t* pGroup, const std::int8_t nByte)
+    {
+#if BENCH_FLAT_HASH_MAP_SSE2
+        const auto ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pGroup));
+        return GroupMask(static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(nByte)))));
+#else
+        unsigned int nMask = 0;
+        for (size_t i = 0; i < groupSize; ++i)
+            nMask |= static_cast<unsigned int>(pGroup[i] == nByte) << i;
+        return GroupMask(nMask);
+#endif
+    }
+
+    // Returns mask of slots that are either empty or deleted, i.e. have the highest bit set.
+    static GroupMask matchEmptyOrDeleted(const std::int8_t* pGroup)
+    {
+#if BENCH_FLAT_HASH_MAP_SSE2
+        return GroupMask(static_cast<unsigned int>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pGroup)))));
+#else
+        unsigned int nMask = 0;
+        for (size_t i = 0; i < groupSize; ++i)
+            nMask |= static_cast<unsigned int>(pGroup[i] < 0) << i;
+        return GroupMask(nMask);
+#endif
+    }
+
+    static bool isFull(const std::int8_t nCtrl) { return nCtrl >= 0; }
+
+    static void prefetch(const void* p)
+    {
+#if BENCH_FLAT_HASH_MAP_SSE2
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#elif defined(__GNUC__)
+        __builtin_prefetch(p);
+#else
+        (void)p;
+#endif
+    }
+
+    // std::hash of integers is typically identity, so hash is mixed to spread entropy to both H1 and H2.
+    size_t mixedHash(const Key_T& key) const
+    {
+        const auto nHash = static_cast<std::uint64_t>(m_hasher(key));
+        return static_cast<size_t>((nHash * 0x9E3779B97F4A7C15ull) ^ ((nHash * 0x9E3779B97F4A7C15ull) >> 32));
+    }
+    static size_t h1(const size_t nHash) { return nHash >> 7; }
+    static std::int8_t h2(const size_t nHash) { return static_cast<std::int8_t>(nHash & 0x7F); }
+
+    template <class Map_T, class Value_T>
+    class IteratorT
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value_T*;
+        using reference = Value_T&;
+
+        IteratorT() = default;
+        IteratorT(Map_T* pMap, const size_t nIndex) : m_pMap(pMap), m_nIndex(nIndex) { skipNonFull(); }
+        // Allows conversion from iterator to const_iterator.
+        template <class OtherMap_T, class OtherValue_T>
+        IteratorT(const IteratorT<OtherMap_T, OtherValue_T>& other) : m_pMap(other.m_pMap), m_nIndex(other.m_nIndex) {}
+
+        reference operator*() const { return m_pMap->m_pSlots[m_nIndex]; }
+        pointer operator->() const { return &m_pMap->m_pSlots[m_nIndex]; }
+        IteratorT& operator++() { ++m_nIndex; skipNonFull(); return *this; }
+        IteratorT operator++(int) { auto rv = *this; ++(*this); return rv; }
+        bool operator==(const IteratorT& other) const { return m_nIndex == other.m_nIndex; }
+        bool operator!=(const IteratorT& other) const { return m_nIndex != other.m_nIndex; }
+
+        Map_T* m_pMap = nullptr;
+        size_t m_nIndex = 0;
+
+    private:
+        void skipNonFull()
+        {
+            while (m_nIndex < m_pMap->m_nCapacity && !isFull(m_pMap->m_pCtrl[m_nIndex]))
+                ++m_nIndex;
+        }
+    }; // class IteratorT
+
+public:
+    using iterator = IteratorT<FlatHashMap, value_type>;
+    using const_iterator = IteratorT<const FlatHashMap, const value_type>;
+
+    FlatHashMap() = default;
+
+    ~FlatHashMap()
+    {
+        destroyAndDeallocate();
+    }
+
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+    {
+        swap(other);
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroyAndDeallocate();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(FlatHashMap& other) noexcept
+    {
+        std::swap(m_pCtrl, other.m_pCtrl);
+        std::swap(m_pSlots, other.m_pSlots);
+        std::swap(m_nCapacity, other.m_nCapacity);
+        std::swap(m_nSize, other.m_nSize);
+        std::swap(m_nGrowthLeft, other.m_nGrowthLeft);
+        std::swap(m_hasher, other.m_hasher);
+        std::swap(m_keyEqual, other.m_keyEqual);
+    }
+
+    iterator begin()                { return iterator(this, 0); }
+    iterator end()                  { return iterator(this, m_nCapacity); }
+    const_iterator begin() const    { return const_iterator(this, 0); }
+    const_iterator end() const      { return const_iterator(this, m_nCapacity); }
+
+    size_t size() const     { return m_nSize; }
+    bool empty() const      { return m_nSize == 0; }
+    // Number of slots.
+    size_t capacity() const { return m_nCapacity; }
+
+    // Number of bytes allocated for slots and control bytes.
+    size_t allocatedBytes() const { return m_nCapacity * (sizeof(value_type) + 1); }
+
+    void clear()
+    {
+        destroyElements();
+        if (m_pCtrl)
+            std::memset(m_pCtrl, ctrlEmpty, m_nCapacity);
+        m_nSize = 0;
+        m_nGrowthLeft = maxLoadCount(m_nCapacity);
+    }
+
+    // Makes room for at least nCount elements without rehashing.
+    void reserve(const size_t nCount)
+    {
+        size_t nCapacity = groupSize;
+        while (maxLoadCount(nCapacity) < nCount)
+            nCapacity *= 2;
+        if (nCapacity > m_nCapacity)
+            rehash(nCapacity);
+    }
+
+    iterator find(const Key_T& key)
+    {
+        return iterator(this, findIndex(key));
+    }
+
+    const_iterator find(const Key_T& key) const
+    {
+        return const_iterator(this, findIndex(key));
+    }
+
+    bool contains(const Key_T& key) const { return findIndex(key) != m_nCapacity; }
+
+    // Number of lookups that are interleaved in findBatch().
+    static constexpr size_t batchSize = 16;
+
+    // For every key in [pKeys, pKeys + nCount), writes pointer to the element with the key to ppResults or nullptr if not found.
+    void findBatch(const Key_T* pKeys, const size_t nCount, const value_type** ppResults) const
+    {
+        if (m_nSize == 0)
+        {
+            std::fill(ppResults, ppResults + nCount, nullptr);
+            return;
+        }
+        const size_t nGroupMask = m_nCapacity / groupSize - 1;
+        size_t hashes[batchSize];
+        for (size_t nFirst = 0; nFirst < nCount; nFirst += batchSize)
+        {
+            const auto nBatch = std::min(batchSize, nCount - nFirst);
+            for (size_t j = 0; j < nBatch; ++j)
+            {
+                hashes[j] = mixedHash(pKeys[nFirst + j]);
+                prefetch(m_pCtrl + (h1(hashes[j]) & nGroupMask) * groupSize);
+            }
+            for (size_t j = 0; j < nBatch; ++j)
+            {
+                const auto nGroupStart = (h1(hashes[j]) & nGroupMask) * groupSize;
+                const auto mask = matchByte(m_pCtrl + nGroupStart, h2(hashes[j]));
+                if (mask)
+                    prefetch(m_pSlots + nGroupStart + mask.lowestIndex());
+            }
+            for (size_t j = 0; j < nBatch; ++j)
+            {
+                const auto nIndex = findIndex(pKeys[nFirst + j], hashes[j]);
+                ppResults[nFirst + j] = (nIndex != m_nCapacity) ? &m_pSlots[nIndex] : nullptr;
+            }
+        }
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return emplaceImpl(value.first, value.second);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        return emplaceImpl(std::move(value.first), std::move(value.second));
+    }
+
+    template <class K, class V>
+    std::pair<iterator, bool> insert(const std::pair<K, V>& value)
+    {
+        return emplaceImpl(Key_T(value.first), value.second);
+    }
+
+    Val_T& operator[](const Key_T& key)
+    {
+        return emplaceImpl(key).first->second;
+    }
+
+    // Returns the number of erased elements (0 or 1). Erased slot is marked deleted (tombstone) unless its group has
+    // empty slots in which case no probe sequence can pass through it and it can be marked empty.
+    size_t erase(const Key_T& key)
+    {
+        const auto nIndex = findIndex(key);
+        if (nIndex == m_nCapacity)
+            return 0;
+        std::destroy_at(&m_pSlots[nIndex]);
+        const auto nGroupStart = nIndex - nIndex % groupSize;
+        if (matchByte(m_pCtrl + nGroupStart, ctrlEmpty))
+        {
+            m_pCtrl[nIndex] = ctrlEmpty;
+            ++m_nGrowthLeft;
+        }
+        else
+            m_pCtrl[nIndex] = ctrlDeleted;
+        --m_nSize;
+        return 1;
+    }
+
+private:
+    static size_t maxLoadCount(const size_t nCapacity) { return nCapacity - nCapacity / 8; }
+
+    size_t capacityForRehash() const
+    {
+        if (m_nCapacity == 0)
+            return groupSize;
+        // If growth ran out mostly because of deleted slots, rehashing to the same capacity is enough to clean them up.
+        return (m_nSize <= maxLoadCount(m_nCapacity) / 2) ? m_nCapacity : 2 * m_nCapacity;
+    }
+
+    // Calls func(nSlotIndex) for slots in probe order until it returns true.
+    template <class Func_T>
+    void forEachProbeGroup(const size_t nHash, Func_T&& func) const
+    {
+        const size_t nGroupMask = m_nCapacity / groupSize - 1;
+        size_t nGroup = h1(nHash) & nGroupMask;
+        for (size_t nStep = 1; ; ++nStep)
+        {
+            if (func(nGroup * groupSize))
+                return;
+            nGroup = (nGroup + nStep) & nGroupMask;
+        }
+    }
+
+    size_t findIndex(const Key_T& key) const
+    {
+        return (m_nSize != 0) ? findIndex(key, mixedHash(key)) : m_nCapacity;
+    }
+
+    size_t findIndex(const Key_T& key, const size_t nHash) const
+    {
+        if (m_nSize == 0)
+            return m_nCapacity;
+        const auto nH2 = h2(nHash);
+        size_t nResult = m_nCapacity;
+        forEachProbeGroup(nHash, [&](const size_t nGroupStart)
+        {
+            const auto pGroup = m_pCtrl + nGroupStart;
+            for (auto mask = matchByte(pGroup, nH2); mask; mask.removeLowest())
+            {
+                const auto nIndex = nGroupStart + mask.lowestIndex();
+                if (m_keyEqual(m_pSlots[nIndex].first, key))
+                {
+                    nResult = nIndex;
+                    return true;
+                }
+            }
+            return static_cast<bool>(matchByte(pGroup, ctrlEmpty)); // Empty slot ends the probe sequence.
+        });
+        return nResult;
+    }
+
+    // Returns index of the first empty or deleted slot in probe sequence of nHash.
+    size_t findInsertIndex(const size_t nHash) const
+    {
+        size_t nResult = 0;
+        forEachProbeGroup(nHash, [&](const size_t nGroupStart)
+        {
+            const auto mask = matchEmptyOrDeleted(m_pCtrl + nGroupStart);
+            if (!mask)
+                return false;
+            nResult = nGroupStart + mask.lowestIndex();
+            return true;
+        });
+        return nResult;
+    }
+
+    template <class K, class... Args_T>
+    std::pair<iterator, bool> emplaceImpl(K&& key, Args_T&&... args)
+    {
+        const auto nHash = mixedHash(key);
+        const auto nExisting = findIndex(key, nHash);
+        if (nExisting != m_nCapacity)
+            return std::pair<iterator, bool>(iterator(this, nExisting), false);
+        if (m_nGrowthLeft == 0)
+            rehash(capacityForRehash());
+        const auto nIndex = findInsertIndex(nHash);
+        ::new (static_cast<void*>(&m_pSlots[nIndex])) value_type(std::piecewise_construct,
+                                                                 std::forward_as_tuple(std::forward<K>(key)),
+                                                                 std::forward_as_tuple(std::forward<Args_T>(args)...));
+        if (m_pCtrl[nIndex] == ctrlEmpty)
+            --m_nGrowthLeft; // Reusing deleted slot doesn't consume growth.
+        m_pCtrl[nIndex] = h2(nHash);
+        ++m_nSize;
+        return std::pair<iterator, bool>(iterator(this, nIndex), true);
+    }
+
+    void rehash(const size_t nNewCapacity)
+    {
+        auto pOldCtrl = m_pCtrl;
+        auto pOldSlots = m_pSlots;
+        const auto nOldCapacity = m_nCapacity;
+
+        m_pCtrl = static_cast<std::int8_t*>(::operator new(nNewCapacity));
+        std::memset(m_pCtrl, ctrlEmpty, nNewCapacity);
+        m_pSlots = std::allocator<value_type>().allocate(nNewCapacity);
+        m_nCapacity = nNewCapacity;
+        m_nGrowthLeft = maxLoadCount(nNewCapacity) - m_nSize;
+
+        for (size_t i = 0; i < nOldCapacity; ++i)
+        {
+            if (!isFull(pOldCtrl[i]))
+                continue;
+            const auto nHash = mixedHash(pOldSlots[i].first);
+            const auto nIndex = findInsertIndex(nHash);
+            ::new (static_cast<void*>(&m_pSlots[nIndex])) value_type(std::move(pOldSlots[i]));
+            std::destroy_at(&pOldSlots[i]);
+            m_pCtrl[nIndex] = h2(nHash);
+        }
+        if (pOldCtrl)
+        {
+            ::operator delete(pOldCtrl);
+            std::allocator<value_type>().deallocate(pOldSlots, nOldCapacity);
+        }
+    }
+
+    void destroyElements()
+    {
+        if constexpr (!std::is_trivially_destructible_v<value_type>)
+        {
+            for (size_t i = 0; i < m_nCapacity; ++i)
+            {
+                if (isFull(m_pCtrl[i]))
+                    std::destroy_at(&m_pSlots[i]);
+            }
+        }
+    }
+
+    void destroyAndDeallocate()
+    {
+        if (!m_pCtrl)
+            return;
+        destroyElements();
+        ::operator delete(m_pCtrl);
+        std::allocator<value_type>().deallocate(m_pSlots, m_nCapacity);
+        m_pCtrl = nullptr;
+        m_pSlots = nullptr;
+        m_nCapacity = 0;
+        m_nSize = 0;
+        m_nGrowthLeft = 0;
+    }
+
+    std::int8_t* m_pCtrl = nullptr;
+    value_type* m_pSlots = nullptr;
+    size_t m_nCapacity = 0;
+    size_t m_nSize = 0;
+    size_t m_nGrowthLeft = 0; // Number of empty slots that can still be filled before exceeding max load factor.
+    Hash_T m_hasher;
+    KeyEqual_T m_keyEqual;
+}; // class FlatHashMap
+
+} // namespace bench
@@ -0,0 +1,251 @@
+#pragma once
+
+/*
+
+RelocatingVector: std::vector-like container that moves elements with a single memmove() when element type is trivially
+relocatable, i.e. when moving an object to new address and not running destructor of the source is equivalent to copying
+its bytes. This is true for many types that are not trivially copyable, for example std::pair<int, int> and
+std::tuple<int, int> which have user-provided assignment operators and therefore make std::vector use element-wise moves
+in insert() and erase() (see insertTest.cpp).
+
+Trivial relocatability is opt-in through IsTriviallyRelocatable<T>: by default it's true for trivially copyable types and
+there are specializations for std::pair and std::tuple whose members are trivially relocatable. Other types can be marked
+with specialization
+    template <> struct bench::IsTriviallyRelocatable<MyType> : std::true_type {};
+For types that are not trivially relocatable, element-wise moves like in std::vector are used.
+
+Interface is the subset of std::vector used by the benchmarks: push_back(), emplace_back(), insert(), erase(), reserve(),
+resize(), clear(), operator[] and iteration through raw pointers.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bench
+{
+
+template <class T>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <class T0, class T1>
+struct IsTriviallyRelocatable<std::pair<T0, T1>> : std::bool_constant<IsTriviallyRelocatable<T0>::value && IsTriviallyRelocatable<T1>::value> {};
+
+template <class... Types_T>
+struct IsTriviallyRelocatable<std::tuple<Types_T...>> : std::bool_constant<(IsTriviallyRelocatable<Types_T>::value && ...)> {};
+
+template <class T>
+constexpr bool isTriviallyRelocatable = IsTriviallyRelocatable<std::remove_cv_t<T>>::value;
+
+template <class T>
+class RelocatingVector
+{
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    RelocatingVector() = default;
+
+    RelocatingVector(const RelocatingVector& other)
+    {
+        reserve(other.size());
+        std::uninitialized_copy(other.begin(), other.end(), m_pData);
+        m_nSize = other.size();
+    }
+
+    RelocatingVector(RelocatingVector&& other) noexcept
+        : m_pData(std::exchange(other.m_pData, nullptr))
+        , m_nSize(std::exchange(other.m_nSize, 0))
+        , m_nCapacity(std::exchange(other.m_nCapacity, 0))
+    {}
+
+    RelocatingVector& operator=(RelocatingVector other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~RelocatingVector()
+    {
+        clear();
+        deallocate(m_pData, m_nCapacity);
+    }
+
+    void swap(RelocatingVector& other) noexcept
+    {
+        std::swap(m_pData, other.m_pData);
+        std::swap(m_nSize, other.m_nSize);
+        std::swap(m_nCapacity, other.m_nCapacity);
+    }
+
+    iterator begin()                { return m_pData; }
+    iterator end()                  { return m_pData + m_nSize; }
+    const_iterator begin() const    { return m_pData; }
+    const_iterator end() const      { return m_pData + m_nSize; }
+    const_iterator cbegin() const   { return begin(); }
+    const_iterator cend() const     { return end(); }
+
+    T* data()               { return m_pData; }
+    const T* data() const   { return m_pData; }
+    size_t size() const     { return m_nSize; }
+    bool empty() const      { return m_nSize == 0; }
+    size_t capacity() const { return m_nCapacity; }
+
+    T& operator[](const size_t i)             { return m_pData[i]; }
+    const T& operator[](const size_t i) const { return m_pData[i]; }
+    T& front()                                { return m_pData[0]; }
+    const T& front() const                    { return m_pData[0]; }
+    T& back()                                 { return m_pData[m_nSize - 1]; }
+    const T& back() const                     { return m_pData[m_nSize - 1]; }
+
+    void reserve(const size_t nCount)
+    {
+        if (nCount <= m_nCapacity)
+            return;
+        T* pNew = allocate(nCount);
+        relocate(m_pData, m_pData + m_nSize, pNew);
+        deallocate(m_pData, m_nCapacity);
+        m_pData = pNew;
+        m_nCapacity = nCount;
+    }
+
+    void resize(const size_t nCount)
+    {
+        if (nCount < m_nSize)
+            erase(begin() + nCount, end());
+        else
+        {
+            reserve(nCount);
+            std::uninitialized_value_construct(m_pData + m_nSize, m_pData + nCount);
+            m_nSize = nCount;
+        }
+    }
+
+    void clear()
+    {
+        std::destroy(begin(), end());
+        m_nSize = 0;
+    }
+
+    template <class... Args_T>
+    T& emplace_back(Args_T&&... args)
+    {
+        if (m_nSize == m_nCapacity)
+        {
+            // Constructs to temporary first in case args refer to an element of this vector.
+            T temp(std::forward<Args_T>(args)...);
+            grow();
+            return *::new(static_cast<void*>(m_pData + m_nSize++)) T(std::move(temp));
+        }
+        return *::new(static_cast<void*>(m_pData + m_nSize++)) T(std::forward<Args_T>(args)...);
+    }
+
+    void push_back(const T& value)  { emplace_back(value); }
+    void push_back(T&& value)       { emplace_back(std::move(value)); }
+
+    void pop_back()
+    {
+        std::destroy_at(m_pData + --m_nSize);
+    }
+
+    iterator insert(const const_iterator iterPos, T value)
+    {
+        const auto nPos = static_cast<size_t>(iterPos - m_pData);
+        if (m_nSize == m_nCapacity)
+            grow();
+        T* const pPos = m_pData + nPos;
+        if constexpr (isTriviallyRelocatable<T>)
+        {
+            std::memmove(static_cast<void*>(pPos + 1), static_cast<const void*>(pPos), (m_nSize - nPos) * sizeof(T));
+            ::new(static_cast<void*>(pPos)) T(std::move(value));
+        }
+        else
+        {
+            if (nPos == m_nSize)
+                ::new(static_cast<void*>(pPos)) T(std::move(value));
+            else
+            {
+                ::new(static_cast<void*>(m_pData + m_nSize)) T(std::move(m_pData[m_nSize - 1]));
+                std::move_backward(pPos, m_pData + m_nSize - 1, m_pData + m_nSize);
+                *pPos = std::move(value);
+            }
+        }
+        ++m_nSize;
+        return pPos;
+    }
+
+    iterator erase(const const_iterator iterPos)
+    {
+        return erase(iterPos, iterPos + 1);
+    }
+
+    iterator erase(const const_iterator iterFirst, const const_iterator iterLast)
+    {
+        T* const pFirst = m_pData + (iterFirst - m_pData);
+        T* const pLast = m_pData + (iterLast - m_pData);
+        if (pFirst == pLast)
+            return pFirst;
+        const auto nTailCount = static_cast<size_t>(end() - pLast);
+        if constexpr (isTriviallyRelocatable<T>)
+        {
+            std::destroy(pFirst, pLast);
+            std::memmove(static_cast<void*>(pFirst), static_cast<const void*>(pLast), nTailCount * sizeof(T));
+        }
+        else
+        {
+            std::move(pLast, end(), pFirst);
+            std::destroy(pFirst + nTailCount, end());
+        }
+        m_nSize -= static_cast<size_t>(pLast - pFirst);
+        return pFirst;
+    }
+
+private:
+    static T* allocate(const size_t nCount)
+    {
+        return std::allocator<T>().allocate(nCount);
+    }
+
+    static void deallocate(T* p, const size_t nCount)
+    {
+        if (p)
+            std::allocator<T>().deallocate(p, nCount);
+    }
+
+    // Moves [pFirst, pLast) to uninitialized storage starting from pDest and ends lifetime of the source objects.
+    static void relocate(T* pFirst, T* pLast, T* pDest)
+    {
+        if constexpr (isTriviallyRelocatable<T>)
+        {
+            if (pFirst != pLast)
+                std::memcpy(static_cast<void*>(pDest), static_cast<const void*>(pFirst), static_cast<size_t>(pLast - pFirst) * sizeof(T));
+        }
+        else
+        {
+            std::uninitialized_move(pFirst, pLast, pDest);
+            std::destroy(pFirst, pLast);
+        }
+    }
+
+    void grow()
+    {
+        reserve((m_nCapacity == 0) ? 8 : 2 * m_nCapacity);
+    }
+
+    T* m_pData = nullptr;
+    size_t m_nSize = 0;
+    size_t m_nCapacity = 0;
+}; // class RelocatingVector
+
+} // namespace bench
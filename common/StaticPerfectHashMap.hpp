@@ -0,0 +1,162 @@
+#pragma once
+
+/*
+
+StaticPerfectHashMap: read-only map from a fixed set of string keys to values, built at compile time with
+makeStaticPerfectHashMap(). The builder searches a hash seed (and if needed, a bigger table) for which all keys land in
+different slots, so find() is one hash, one slot access and one key comparison, without allocation.
+
+Hash:
+    -By default only length, the first 8 and the last 8 bytes are hashed, which keeps the hash cost independent of the
+     lookup string length. If no collision-free seed is found with it (keys that differ only in the middle), the builder
+     falls back to hashing all bytes.
+    -Table size is a power of two, from the smallest one that fits the keys up to 4 times that.
+
+find() takes std::string_view, so std::string and string_view are looked up without conversion costs and const char* with
+one strlen(). Keys must be unique, otherwise construction fails (compile error in constant evaluation).
+
+Example:
+    constexpr std::pair<std::string_view, int> items[] = { {"abc", 1}, {"def", 2} };
+    constexpr auto m = bench::makeStaticPerfectHashMap(items);
+    const int* p = m.find("abc"); // p points to 1
+
+Requires C++17.
+
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace bench
+{
+
+namespace detail
+{
+    constexpr uint64_t perfectHashMix(uint64_t x)
+    {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    // Reads up to 8 bytes starting from nPos as little-endian integer; bytes past the end are zero.
+    constexpr uint64_t perfectHashLoad8(const std::string_view sv, const size_t nPos)
+    {
+        uint64_t n = 0;
+        for (size_t i = 0; i < 8 && nPos + i < sv.size(); ++i)
+            n |= uint64_t(static_cast<unsigned char>(sv[nPos + i])) << (8 * i);
+        return n;
+    }
+
+    constexpr uint64_t perfectHash(const std::string_view sv, const uint64_t nSeed, const bool bFullHash)
+    {
+        uint64_t h = perfectHashMix(nSeed ^ (sv.size() * 0x9E3779B97F4A7C15ULL));
+        if (bFullHash)
+        {
+            for (size_t i = 0; i < sv.size(); i += 8)
+                h = perfectHashMix(h ^ perfectHashLoad8(sv, i));
+        }
+        else
+        {
+            h = perfectHashMix(h ^ perfectHashLoad8(sv, 0));
+            if (sv.size() > 8)
+                h = perfectHashMix(h ^ perfectHashLoad8(sv, sv.size() - 8));
+        }
+        return h;
+    }
+
+    constexpr size_t perfectHashMinTableSize(const size_t nKeyCount)
+    {
+        size_t n = 1;
+        while (n < nKeyCount)
+            n *= 2;
+        return n;
+    }
+} // namespace detail
+
+template <class Val_T, size_t KeyCount_T>
+class StaticPerfectHashMap
+{
+public:
+    using value_type = std::pair<std::string_view, Val_T>;
+
+    static constexpr size_t maxTableSize = 4 * detail::perfectHashMinTableSize(KeyCount_T);
+    static constexpr uint64_t maxSeedCountPerTableSize = 1024;
+
+    constexpr StaticPerfectHashMap(const value_type (&items)[KeyCount_T])
+    {
+        for (const bool bFullHash : { false, true })
+        {
+            for (size_t nTableSize = detail::perfectHashMinTableSize(KeyCount_T); nTableSize <= maxTableSize; nTableSize *= 2)
+            {
+                for (uint64_t nSeed = 0; nSeed < maxSeedCountPerTableSize; ++nSeed)
+                {
+                    if (tryBuild(items, nTableSize, nSeed, bFullHash))
+                        return;
+                }
+            }
+        }
+        throw std::logic_error("StaticPerfectHashMap: no perfect hash found, are keys unique?");
+    }
+
+    // Returns pointer to value of key or nullptr if key is not in the map.
+    constexpr const Val_T* find(const std::string_view key) const
+    {
+        const auto& slot = m_slots[detail::perfectHash(key, m_nSeed, m_bFullHash) & m_nMask];
+        return (slot.m_bOccupied && slot.m_key == key) ? &slot.m_value : nullptr;
+    }
+
+    constexpr bool contains(const std::string_view key) const { return find(key) != nullptr; }
+
+    static constexpr size_t size()    { return KeyCount_T; }
+    constexpr size_t tableSize() const  { return m_nMask + 1; }
+    constexpr bool isFullHash() const   { return m_bFullHash; }
+
+private:
+    // Key and value are stored separately instead of value_type as std::pair assignment is not constexpr before C++20.
+    struct Slot
+    {
+        std::string_view m_key;
+        Val_T m_value{};
+        bool m_bOccupied = false;
+    };
+
+    constexpr bool tryBuild(const value_type (&items)[KeyCount_T], const size_t nTableSize, const uint64_t nSeed, const bool bFullHash)
+    {
+        for (auto& slot : m_slots)
+            slot.m_bOccupied = false;
+        for (const auto& item : items)
+        {
+            auto& slot = m_slots[detail::perfectHash(item.first, nSeed, bFullHash) & (nTableSize - 1)];
+            if (slot.m_bOccupied)
+                return false;
+            slot.m_key = item.first;
+            slot.m_value = item.second;
+            slot.m_bOccupied = true;
+        }
+        m_nMask = nTableSize - 1;
+        m_nSeed = nSeed;
+        m_bFullHash = bFullHash;
+        return true;
+    }
+
+    std::array<Slot, maxTableSize> m_slots{};
+    size_t m_nMask = 0;
+    uint64_t m_nSeed = 0;
+    bool m_bFullHash = false;
+}; // class StaticPerfectHashMap
+
+template <class Val_T, size_t KeyCount_T>
+constexpr StaticPerfectHashMap<Val_T, KeyCount_T> makeStaticPerfectHashMap(const std::pair<std::string_view, Val_T> (&items)[KeyCount_T])
+{
+    return StaticPerfectHashMap<Val_T, KeyCount_T>(items);
+}
+
+} // namespace bench
@@ -0,0 +1,177 @@
+#pragma once
+
+/*
+
+StringPoolFlatMap: read-mostly sorted flat map from strings to values where all key characters are stored back-to-back in
+one character arena and the map itself is a sorted array of (offset, length) entries with values in a parallel array.
+
+Compared to flat maps of std::string keys:
+    -Keys take one allocation in total instead of one per key that doesn't fit to small string buffer.
+    -Entry is 8 bytes (32-bit offset and length) instead of sizeof(std::string), so binary search touches fewer cache lines
+     and the arena of a map built with assign() is in key order, so the last steps of a search read nearby characters.
+    -Keys are returned as std::string_view to the arena, no copies.
+
+Building:
+    -assign(first, last): bulk build from pair-like items whose first is convertible to std::string_view. Items are sorted
+     once and the arena is laid out in key order. With duplicate keys, the first item in input order is kept.
+    -insert(key, value): inserts to sorted position, i.e. O(n) entry moves like with other sorted vector maps; key characters
+     are appended to the arena, so existing characters are never moved.
+
+find() takes std::string_view, so lookups with std::string and string_view need no conversions and const char* one strlen().
+Total length of keys is limited to 2^32 - 1 characters; std::length_error is thrown if exceeded.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+template <class Val_T>
+class StringPoolFlatMap
+{
+public:
+    using key_type = std::string_view;
+    using mapped_type = Val_T;
+
+    struct Entry
+    {
+        uint32_t m_nOffset;
+        uint32_t m_nLength;
+    };
+
+    StringPoolFlatMap() = default;
+
+    template <class Iter_T>
+    StringPoolFlatMap(Iter_T first, Iter_T last)
+    {
+        assign(first, last);
+    }
+
+    // Replaces content with items of [first, last), see file comment. Requires forward iterators.
+    template <class Iter_T>
+    void assign(Iter_T first, Iter_T last)
+    {
+        clear();
+        const auto nItemCount = static_cast<size_t>(std::distance(first, last));
+        std::vector<std::pair<std::string_view, size_t>> order; // Key and index in input.
+        order.reserve(nItemCount);
+        size_t nCharCount = 0;
+        {
+            size_t i = 0;
+            for (auto iter = first; iter != last; ++iter, ++i)
+            {
+                const std::string_view sv(iter->first);
+                order.emplace_back(sv, i);
+                nCharCount += sv.size();
+            }
+        }
+        std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        order.erase(std::unique(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first == b.first; }), order.end());
+
+        std::vector<size_t> inputIndexToOrder(nItemCount, nItemCount); // nItemCount marks dropped duplicates.
+        for (size_t j = 0; j < order.size(); ++j)
+            inputIndexToOrder[order[j].second] = j;
+
+        reserve(order.size(), nCharCount);
+        for (const auto& item : order)
+            m_entries.push_back(appendChars(item.first));
+        // Values are copied in a second pass in input order so that Iter_T needs to be only a forward iterator.
+        m_values.resize(order.size());
+        size_t i = 0;
+        for (auto iter = first; iter != last; ++iter, ++i)
+        {
+            if (inputIndexToOrder[i] != nItemCount)
+                m_values[inputIndexToOrder[i]] = iter->second;
+        }
+    }
+
+    // Inserts key with value if key doesn't exist; returns true if inserted.
+    bool insert(const std::string_view key, Val_T value)
+    {
+        const auto iterEntry = lowerBound(key);
+        if (iterEntry != m_entries.end() && keyOf(*iterEntry) == key)
+            return false;
+        const auto nIndex = iterEntry - m_entries.begin();
+        const auto entry = appendChars(key);
+        m_entries.insert(m_entries.begin() + nIndex, entry);
+        m_values.insert(m_values.begin() + nIndex, std::move(value));
+        return true;
+    }
+
+    // Returns pointer to value of key or nullptr if key is not in the map.
+    const Val_T* find(const std::string_view key) const
+    {
+        const auto iterEntry = lowerBound(key);
+        return (iterEntry != m_entries.end() && keyOf(*iterEntry) == key) ? &m_values[iterEntry - m_entries.begin()] : nullptr;
+    }
+
+    Val_T* find(const std::string_view key)
+    {
+        return const_cast<Val_T*>(static_cast<const StringPoolFlatMap&>(*this).find(key));
+    }
+
+    bool contains(const std::string_view key) const { return find(key) != nullptr; }
+
+    std::string_view keyAt(const size_t i) const   { return keyOf(m_entries[i]); }
+    const Val_T& valueAt(const size_t i) const      { return m_values[i]; }
+    Val_T& valueAt(const size_t i)                  { return m_values[i]; }
+
+    size_t size() const         { return m_entries.size(); }
+    bool empty() const          { return m_entries.empty(); }
+    size_t charCount() const    { return m_chars.size(); }
+
+    // Returns number of bytes allocated by the map (capacities of arena, entries and values).
+    size_t allocatedBytes() const
+    {
+        return m_chars.capacity() + m_entries.capacity() * sizeof(Entry) + m_values.capacity() * sizeof(Val_T);
+    }
+
+    void reserve(const size_t nKeyCount, const size_t nCharCount)
+    {
+        m_chars.reserve(nCharCount);
+        m_entries.reserve(nKeyCount);
+        m_values.reserve(nKeyCount);
+    }
+
+    void clear()
+    {
+        m_chars.clear();
+        m_entries.clear();
+        m_values.clear();
+    }
+
+private:
+    std::string_view keyOf(const Entry& entry) const
+    {
+        return std::string_view(m_chars.data() + entry.m_nOffset, entry.m_nLength);
+    }
+
+    typename std::vector<Entry>::const_iterator lowerBound(const std::string_view key) const
+    {
+        return std::lower_bound(m_entries.begin(), m_entries.end(), key, [&](const Entry& entry, const std::string_view sv) { return keyOf(entry) < sv; });
+    }
+
+    Entry appendChars(const std::string_view sv)
+    {
+        const auto nOffset = m_chars.size();
+        if (sv.size() > (std::numeric_limits<uint32_t>::max)() - nOffset)
+            throw std::length_error("StringPoolFlatMap: total key length exceeds 2^32 - 1");
+        m_chars.insert(m_chars.end(), sv.begin(), sv.end());
+        return Entry{ static_cast<uint32_t>(nOffset), static_cast<uint32_t>(sv.size()) };
+    }
+
+    std::vector<char> m_chars;
+    std::vector<Entry> m_entries;
+    std::vector<Val_T> m_values;
+}; // class StringPoolFlatMap
+
+} // namespace bench
@@ -0,0 +1,194 @@
+#pragma once
+
+/*
+
+TieredVector: sequence container with random access and insert() to arbitrary position in O(sqrt(n))-like time instead
+of the O(n) element shifting of std::vector, written as a benchmark contender for random position insert.
+
+Layout:
+    -Elements are stored in blocks of BlockSize_T elements (power of two), all blocks in one contiguous buffer. Every block
+     is a circular buffer: element j of block b is at slot (head[b] + j) % BlockSize_T of the block.
+    -All blocks except the last are full, so element i is element i % BlockSize_T of block i / BlockSize_T and random access
+     is a couple of shifts and masks.
+    -insert(pos) shifts elements only within the block of pos (at most BlockSize_T moves) and then moves the last element of
+     every following block to the front of the next block, which for circular blocks is a single move and head decrement.
+     With n elements insert therefore costs O(BlockSize_T + n / BlockSize_T) moves.
+
+Interface is the subset of std::vector used by the benchmarks: push_back(), insert(iterator, value), operator[], size(),
+reserve(), clear() and random access iteration. T must be default constructible and move assignable, as storage is
+allocated per block with value initialized elements. Iterators are index-based, so they are not invalidated by growth, but
+like with std::vector insert changes the element that an iterator past the insert position refers to.
+
+*/
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+template <class T, size_t BlockSize_T = 256>
+class TieredVector
+{
+public:
+    static_assert(BlockSize_T > 0 && (BlockSize_T & (BlockSize_T - 1)) == 0, "TieredVector block size must be a power of two");
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+
+    static constexpr size_t blockSize = BlockSize_T;
+
+    template <bool IsConst_T>
+    class IteratorT
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst_T, const T*, T*>;
+        using reference = std::conditional_t<IsConst_T, const T&, T&>;
+        using ContainerPtr = std::conditional_t<IsConst_T, const TieredVector*, TieredVector*>;
+
+        IteratorT() = default;
+        IteratorT(ContainerPtr pCont, const size_t nIndex) : m_pCont(pCont), m_nIndex(nIndex) {}
+        // Conversion from iterator to const_iterator.
+        template <bool IsOtherConst_T, class = std::enable_if_t<IsConst_T && !IsOtherConst_T>>
+        IteratorT(const IteratorT<IsOtherConst_T>& other) : m_pCont(other.m_pCont), m_nIndex(other.m_nIndex) {}
+
+        reference operator*() const                         { return (*m_pCont)[m_nIndex]; }
+        pointer operator->() const                          { return &(*m_pCont)[m_nIndex]; }
+        reference operator[](const difference_type n) const { return (*m_pCont)[m_nIndex + n]; }
+
+        IteratorT& operator++()                         { ++m_nIndex; return *this; }
+        IteratorT operator++(int)                       { auto temp = *this; ++m_nIndex; return temp; }
+        IteratorT& operator--()                         { --m_nIndex; return *this; }
+        IteratorT operator--(int)                       { auto temp = *this; --m_nIndex; return temp; }
+        IteratorT& operator+=(const difference_type n)  { m_nIndex += n; return *this; }
+        IteratorT& operator-=(const difference_type n)  { m_nIndex -= n; return *this; }
+        IteratorT operator+(const difference_type n) const { return IteratorT(m_pCont, m_nIndex + n); }
+        IteratorT operator-(const difference_type n) const { return IteratorT(m_pCont, m_nIndex - n); }
+        friend IteratorT operator+(const difference_type n, const IteratorT& iter) { return iter + n; }
+        difference_type operator-(const IteratorT& other) const { return static_cast<difference_type>(m_nIndex) - static_cast<difference_type>(other.m_nIndex); }
+
+        bool operator==(const IteratorT& other) const { return m_nIndex == other.m_nIndex; }
+        bool operator!=(const IteratorT& other) const { return m_nIndex != other.m_nIndex; }
+        bool operator<(const IteratorT& other) const  { return m_nIndex < other.m_nIndex; }
+        bool operator>(const IteratorT& other) const  { return m_nIndex > other.m_nIndex; }
+        bool operator<=(const IteratorT& other) const { return m_nIndex <= other.m_nIndex; }
+        bool operator>=(const IteratorT& other) const { return m_nIndex >= other.m_nIndex; }
+
+        size_t index() const { return m_nIndex; }
+
+    private:
+        template <bool> friend class IteratorT;
+
+        ContainerPtr m_pCont = nullptr;
+        size_t m_nIndex = 0;
+    }; // class IteratorT
+
+    using iterator = IteratorT<false>;
+    using const_iterator = IteratorT<true>;
+
+    iterator begin()                { return iterator(this, 0); }
+    iterator end()                  { return iterator(this, m_nSize); }
+    const_iterator begin() const    { return const_iterator(this, 0); }
+    const_iterator end() const      { return const_iterator(this, m_nSize); }
+    const_iterator cbegin() const   { return begin(); }
+    const_iterator cend() const     { return end(); }
+
+    size_t size() const     { return m_nSize; }
+    bool empty() const      { return m_nSize == 0; }
+    size_t capacity() const { return m_storage.size(); }
+
+    T& operator[](const size_t i)             { return m_storage[slotIndex(i >> blockShift(), i & blockMask)]; }
+    const T& operator[](const size_t i) const { return m_storage[slotIndex(i >> blockShift(), i & blockMask)]; }
+
+    T& front()              { return (*this)[0]; }
+    const T& front() const  { return (*this)[0]; }
+    T& back()               { return (*this)[m_nSize - 1]; }
+    const T& back() const   { return (*this)[m_nSize - 1]; }
+
+    void reserve(const size_t nCount)
+    {
+        if (nCount <= capacity())
+            return;
+        const auto nBlockCount = (nCount + blockMask) >> blockShift();
+        m_storage.resize(nBlockCount * BlockSize_T);
+        m_heads.resize(nBlockCount, 0);
+    }
+
+    void clear()
+    {
+        m_storage.clear();
+        m_heads.clear();
+        m_nSize = 0;
+    }
+
+    void push_back(T value)
+    {
+        if (m_nSize == capacity())
+            addBlock();
+        (*this)[m_nSize] = std::move(value);
+        ++m_nSize;
+    }
+
+    iterator insert(const const_iterator iterPos, T value)
+    {
+        const auto nPos = iterPos.index();
+        if (m_nSize == capacity())
+            addBlock();
+        const auto nPosBlock = nPos >> blockShift();
+        const auto nLastBlock = m_nSize >> blockShift(); // Block that gets a new slot.
+
+        // Moves last element of every full block in (nPosBlock, nLastBlock] to the front of the next block. Since block
+        // nBlock - 1 is full, the slot freed from its end is the slot before its head, i.e. where its head moves to next.
+        for (size_t nBlock = nLastBlock; nBlock > nPosBlock; --nBlock)
+        {
+            m_heads[nBlock] = (m_heads[nBlock] - 1) & blockMask;
+            m_storage[slotIndex(nBlock, 0)] = std::move(m_storage[slotIndex(nBlock - 1, blockMask)]);
+        }
+
+        // Shifts elements of the insert block after nPos by one; the last slot of the block is free at this point.
+        const auto nBlockEnd = (nPosBlock == nLastBlock) ? (m_nSize & blockMask) : blockMask;
+        const auto nPosInBlock = nPos & blockMask;
+        for (size_t j = nBlockEnd; j > nPosInBlock; --j)
+            m_storage[slotIndex(nPosBlock, j)] = std::move(m_storage[slotIndex(nPosBlock, j - 1)]);
+        m_storage[slotIndex(nPosBlock, nPosInBlock)] = std::move(value);
+        ++m_nSize;
+        return iterator(this, nPos);
+    }
+
+private:
+    static constexpr size_t blockMask = BlockSize_T - 1;
+
+    static constexpr size_t blockShift()
+    {
+        size_t nShift = 0;
+        while ((size_t(1) << nShift) < BlockSize_T)
+            ++nShift;
+        return nShift;
+    }
+
+    // Returns storage index of element j (0 = first) of given block.
+    size_t slotIndex(const size_t nBlock, const size_t j) const
+    {
+        return (nBlock << blockShift()) + ((m_heads[nBlock] + j) & blockMask);
+    }
+
+    void addBlock()
+    {
+        reserve((capacity() == 0) ? BlockSize_T : 2 * capacity());
+    }
+
+    std::vector<T> m_storage;
+    std::vector<size_t> m_heads; // Head slot of every block.
+    size_t m_nSize = 0;
+}; // class TieredVector
+
+} // namespace bench
@@ -0,0 +1,197 @@
+#pragma once
+
+/*
+
+TombstoneFlatMap: sorted vector map (keys and values in separate arrays like MapVectorSoA) with lazy deletion.
+
+In sorted vector maps every erase shifts the elements after the erased one, so erasing k random keys costs O(k * n) moves.
+Here erase only marks the slot dead (tombstone): the key stays in place, so the key array stays sorted and binary search
+works unchanged; find() just treats dead slot as not found. Dead slots are removed in one compaction pass once their
+share of all slots exceeds maxDeadRatio (default 0.25), so an erase costs amortized O(log n) search plus O(1 / maxDeadRatio)
+moves. Range erase marks all slots in the range dead, O(log n + number of slots in range).
+
+Insert of a key that has a dead slot revives the slot and insert next to a dead slot reuses it when that keeps keys
+sorted, so erase-insert churn in the same key area needs no shifts; otherwise insert is O(n) like in other sorted vector
+maps.
+
+find() returns pointer to value or nullptr like StringPoolFlatMap. Key type must be copy-assignable and less-than comparable.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+template <class Key_T, class Val_T>
+class TombstoneFlatMap
+{
+public:
+    using key_type = Key_T;
+    using mapped_type = Val_T;
+
+    // Inserts key with value if key doesn't exist; returns true if inserted.
+    bool insert(const Key_T& key, Val_T value)
+    {
+        const auto nPos = lowerBoundIndex(key);
+        if (nPos < m_keys.size() && !(key < m_keys[nPos]))
+        {
+            if (!m_dead[nPos])
+                return false;
+            reviveSlot(nPos, key, std::move(value));
+            return true;
+        }
+        // Reusing dead neighbour slot keeps keys sorted because m_keys[nPos - 1] < key < m_keys[nPos].
+        if (nPos < m_keys.size() && m_dead[nPos])
+            reviveSlot(nPos, key, std::move(value));
+        else if (nPos > 0 && m_dead[nPos - 1])
+            reviveSlot(nPos - 1, key, std::move(value));
+        else
+        {
+            m_keys.insert(m_keys.begin() + nPos, key);
+            m_values.insert(m_values.begin() + nPos, std::move(value));
+            m_dead.insert(m_dead.begin() + nPos, uint8_t(0));
+        }
+        return true;
+    }
+
+    // Returns pointer to value of key or nullptr if key is not in the map.
+    const Val_T* find(const Key_T& key) const
+    {
+        const auto nPos = lowerBoundIndex(key);
+        return (nPos < m_keys.size() && !(key < m_keys[nPos]) && !m_dead[nPos]) ? &m_values[nPos] : nullptr;
+    }
+
+    Val_T* find(const Key_T& key)
+    {
+        return const_cast<Val_T*>(static_cast<const TombstoneFlatMap&>(*this).find(key));
+    }
+
+    bool contains(const Key_T& key) const { return find(key) != nullptr; }
+
+    // Returns the number of erased elements (0 or 1).
+    size_t erase(const Key_T& key)
+    {
+        const auto nPos = lowerBoundIndex(key);
+        if (nPos == m_keys.size() || key < m_keys[nPos] || m_dead[nPos])
+            return 0;
+        markDead(nPos);
+        compactIfNeeded();
+        return 1;
+    }
+
+    // Erases keys in [first, last); returns the number of erased elements.
+    size_t eraseRange(const Key_T& first, const Key_T& last)
+    {
+        const auto nBegin = lowerBoundIndex(first);
+        const auto nEnd = (std::max)(nBegin, lowerBoundIndex(last));
+        size_t nErased = 0;
+        for (size_t i = nBegin; i < nEnd; ++i)
+        {
+            if (!m_dead[i])
+            {
+                markDead(i);
+                ++nErased;
+            }
+        }
+        compactIfNeeded();
+        return nErased;
+    }
+
+    // Calls func(key, value) for every live element in key order.
+    template <class Func_T>
+    void forEach(Func_T&& func) const
+    {
+        for (size_t i = 0; i < m_keys.size(); ++i)
+        {
+            if (!m_dead[i])
+                func(m_keys[i], m_values[i]);
+        }
+    }
+
+    // Removes dead slots, O(n).
+    void compact()
+    {
+        if (m_nDeadCount == 0)
+            return;
+        size_t nDest = 0;
+        for (size_t i = 0; i < m_keys.size(); ++i)
+        {
+            if (m_dead[i])
+                continue;
+            if (nDest != i)
+            {
+                m_keys[nDest] = std::move(m_keys[i]);
+                m_values[nDest] = std::move(m_values[i]);
+            }
+            ++nDest;
+        }
+        m_keys.resize(nDest);
+        m_values.resize(nDest);
+        m_dead.assign(nDest, uint8_t(0));
+        m_nDeadCount = 0;
+    }
+
+    size_t size() const         { return m_keys.size() - m_nDeadCount; }
+    bool empty() const          { return size() == 0; }
+    size_t slotCount() const    { return m_keys.size(); }
+    size_t deadCount() const    { return m_nDeadCount; }
+
+    double maxDeadRatio() const { return m_maxDeadRatio; }
+    // Sets dead slot share that triggers compaction; 0 compacts on every erase, i.e. behaves like eager erase.
+    void setMaxDeadRatio(const double ratio) { m_maxDeadRatio = ratio; compactIfNeeded(); }
+
+    void reserve(const size_t nCount)
+    {
+        m_keys.reserve(nCount);
+        m_values.reserve(nCount);
+        m_dead.reserve(nCount);
+    }
+
+    void clear()
+    {
+        m_keys.clear();
+        m_values.clear();
+        m_dead.clear();
+        m_nDeadCount = 0;
+    }
+
+private:
+    size_t lowerBoundIndex(const Key_T& key) const
+    {
+        return static_cast<size_t>(std::lower_bound(m_keys.begin(), m_keys.end(), key) - m_keys.begin());
+    }
+
+    void markDead(const size_t nPos)
+    {
+        m_dead[nPos] = 1;
+        m_values[nPos] = Val_T(); // Releases resources of value now rather than at compaction.
+        ++m_nDeadCount;
+    }
+
+    void reviveSlot(const size_t nPos, const Key_T& key, Val_T&& value)
+    {
+        m_keys[nPos] = key;
+        m_values[nPos] = std::move(value);
+        m_dead[nPos] = 0;
+        --m_nDeadCount;
+    }
+
+    void compactIfNeeded()
+    {
+        if (m_nDeadCount > 0 && static_cast<double>(m_nDeadCount) > m_maxDeadRatio * static_cast<double>(m_keys.size()))
+            compact();
+    }
+
+    std::vector<Key_T> m_keys;
+    std::vector<Val_T> m_values;
+    std::vector<uint8_t> m_dead; // Non-zero for dead slot; not std::vector<bool> to keep lookups free of bit arithmetic.
+    size_t m_nDeadCount = 0;
+    double m_maxDeadRatio = 0.25;
+}; // class TombstoneFlatMap
+
+} // namespace bench
@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+
+Batched inserts to vectors and sorted vector-based maps.
+
+Inserting k elements one by one to random positions of a vector of n elements costs O(k * n) element moves. When inserts
+come in batches, they can be applied with one backward merge pass instead: the vector is grown once by k elements and,
+starting from the end, every existing element is moved at most once directly to its final position. Cost is
+O(n + k log k) (the log factor only if batch is not sorted) and no memory is allocated if capacity is already reserved.
+
+    -insertBatch():       inserts values to given positions of a vector. Positions refer to the vector before the batch,
+                          i.e. values[i] is inserted before element that was at positions[i] (positions[i] == size()
+                          means append). Values with equal positions are inserted in batch order. Result equals to
+                          inserting the values one by one in order of ascending position, adjusting each position by the
+                          number of values already inserted.
+    -insertBatchSorted(): inserts batch of key-value pairs sorted and unique by key to storage of sorted unique elements,
+                          e.g. storage of MapVectorAoS or sequence of boost::flat_map. Like map insert, keys that already
+                          exist are not inserted.
+
+Vectors need resize() and operator[], so element type must be default constructible. If vector has data() and element type
+is trivially relocatable (see RelocatingVector.hpp) and trivially destructible, elements are moved with memmove() also when
+they are not trivially copyable, e.g. std::pair<int, int>.
+
+*/
+
+#include "RelocatingVector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+namespace detail
+{
+    // Like std::move_backward(vec[nFirst, nLast), vec[.., nDestLast)), but with memmove() when it's allowed for element type.
+    template <class Vec_T>
+    void moveBackwardInVector(Vec_T& vec, const size_t nFirst, const size_t nLast, const size_t nDestLast)
+    {
+        using value_type = typename Vec_T::value_type;
+        if constexpr (isTriviallyRelocatable<value_type> && std::is_trivially_destructible_v<value_type> && requires { vec.data(); })
+        {
+            auto pData = vec.data();
+            std::memmove(static_cast<void*>(pData + nDestLast - (nLast - nFirst)), static_cast<const void*>(pData + nFirst), (nLast - nFirst) * sizeof(value_type));
+        }
+        else
+            std::move_backward(vec.begin() + nFirst, vec.begin() + nLast, vec.begin() + nDestLast);
+    }
+
+    // Merge of insertBatch() for positions in ascending order; pOrder, if given, tells the order in which batch items are read.
+    template <class Vec_T, class Value_T>
+    void insertBatchMerge(Vec_T& vec, const size_t* pPositions, const Value_T* pValues, const size_t* pOrder, const size_t nCount)
+    {
+        const size_t nOldSize = vec.size();
+        vec.resize(nOldSize + nCount);
+        size_t nSrc = nOldSize;
+        size_t nDest = nOldSize + nCount;
+        for (size_t j = nCount; j > 0; --j)
+        {
+            const auto nItem = (pOrder) ? pOrder[j - 1] : j - 1;
+            const auto nPos = pPositions[nItem];
+            moveBackwardInVector(vec, nPos, nSrc, nDest);
+            nDest -= nSrc - nPos;
+            nSrc = nPos;
+            vec[--nDest] = pValues[nItem];
+        }
+    }
+} // namespace detail
+
+// Inserts pValues[i] before element that was at index pPositions[i] in vec before the call, see file comment for details.
+// If positions are not in ascending order, they are sorted through an index array of nCount elements.
+template <class Vec_T>
+void insertBatch(Vec_T& vec, const size_t* pPositions, const typename Vec_T::value_type* pValues, const size_t nCount)
+{
+    if (std::is_sorted(pPositions, pPositions + nCount))
+    {
+        detail::insertBatchMerge(vec, pPositions, pValues, nullptr, nCount);
+        return;
+    }
+    std::vector<size_t> order(nCount);
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return pPositions[a] < pPositions[b]; });
+    detail::insertBatchMerge(vec, pPositions, pValues, order.data(), nCount);
+}
+
+// Inserts [pBatch, pBatch + nCount), which must be sorted and unique by keyOf(item), to storage of elements sorted and
+// unique by keyOf(item). Items whose key already exists in storage are skipped. Returns the number of inserted items.
+// keyOf must accept both storage elements and batch items.
+template <class Cont_T, class Item_T, class KeyFunc_T>
+size_t insertBatchSorted(Cont_T& storage, const Item_T* pBatch, const size_t nCount, KeyFunc_T keyOf)
+{
+    const auto elementLess = [&](const auto& element, const Item_T& item) { return keyOf(element) < keyOf(item); };
+    const auto itemLess = [&](const Item_T& item, const auto& element) { return keyOf(item) < keyOf(element); };
+    const size_t nOldSize = storage.size();
+
+    // Counts new keys with binary searches so that storage can be resized before merging; search range shrinks as both
+    // sequences are sorted.
+    size_t nNewCount = 0;
+    {
+        auto iterSearchBegin = storage.begin();
+        for (size_t j = 0; j < nCount; ++j)
+        {
+            iterSearchBegin = std::lower_bound(iterSearchBegin, storage.end(), pBatch[j], elementLess);
+            nNewCount += (iterSearchBegin == storage.end() || keyOf(*iterSearchBegin) != keyOf(pBatch[j]));
+        }
+    }
+    if (nNewCount == 0)
+        return 0;
+
+    storage.resize(nOldSize + nNewCount);
+    size_t nSrc = nOldSize;
+    size_t nDest = nOldSize + nNewCount;
+    for (size_t j = nCount; j > 0 && nDest != nSrc; --j)
+    {
+        const auto& item = pBatch[j - 1];
+        // Elements after item are [nPos, nSrc).
+        const auto iterPos = std::upper_bound(storage.begin(), storage.begin() + nSrc, item, itemLess);
+        const auto nPos = static_cast<size_t>(iterPos - storage.begin());
+        detail::moveBackwardInVector(storage, nPos, nSrc, nDest);
+        nDest -= nSrc - nPos;
+        nSrc = nPos;
+        if (nSrc > 0 && keyOf(storage[nSrc - 1]) == keyOf(item))
+            continue; // Key exists, not inserted.
+        storage[--nDest] = item;
+    }
+    return nNewCount;
+}
+
+} // namespace bench
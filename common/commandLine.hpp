@@ -0,0 +1,53 @@
+#pragma once
+
+// Small helpers for parsing benchmark command line options of form --name=value.
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench
+{
+
+struct CommandLineArg
+{
+    std::string_view name;  // For example "--count" in "--count=1e7"
+    std::string value;      // For example "1e7" in "--count=1e7", empty if argument has no '='.
+};
+
+inline CommandLineArg splitCommandLineArg(const std::string_view sArg)
+{
+    const auto nEqPos = sArg.find('=');
+    return CommandLineArg{ sArg.substr(0, nEqPos), std::string(nEqPos != std::string_view::npos ? sArg.substr(nEqPos + 1) : std::string_view()) };
+}
+
+inline std::vector<std::string> splitByComma(std::string_view sv)
+{
+    std::vector<std::string> items;
+    while (!sv.empty())
+    {
+        const auto nPos = sv.find(',');
+        if (nPos != 0)
+            items.emplace_back(sv.substr(0, nPos));
+        if (nPos == std::string_view::npos)
+            break;
+        sv.remove_prefix(nPos + 1);
+    }
+    return items;
+}
+
+// Parses positive integer count that fits in int, accepts scientific notation such as 1e7. Returns empty if invalid.
+inline std::optional<int> parseCount(const std::string& s)
+{
+    char* pEnd = nullptr;
+    const double val = std::strtod(s.c_str(), &pEnd);
+    if (pEnd == s.c_str() || *pEnd != '\0' || !(val >= 1) || val > std::numeric_limits<int>::max() || std::floor(val) != val)
+        return std::nullopt;
+    return static_cast<int>(val);
+}
+
+} // namespace bench
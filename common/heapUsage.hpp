@@ -0,0 +1,37 @@
+#pragma once
+
+/*
+
+Heap usage query for memory columns of benchmarks.
+
+heapBytesInUse() returns the number of bytes currently allocated through malloc (and therefore through default operator new)
+including allocator bookkeeping, or empty if not available on current platform. Memory usage of a container can be
+estimated as the difference of the values after and before building it. Currently available only with glibc 2.33 or newer
+(mallinfo2()); BENCH_HAS_MALLINFO2 tells whether it is.
+
+*/
+
+#include <cstdint>
+#include <optional>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    #define BENCH_HAS_MALLINFO2 1
+    #include <malloc.h>
+#else
+    #define BENCH_HAS_MALLINFO2 0
+#endif
+
+namespace bench
+{
+
+inline std::optional<std::int64_t> heapBytesInUse()
+{
+#if BENCH_HAS_MALLINFO2
+    const auto info = mallinfo2();
+    return static_cast<std::int64_t>(info.uordblks + info.hblkhd);
+#else
+    return std::nullopt;
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,295 @@
+#pragma once
+
+/*
+
+Coroutine-interleaved lookups for hiding memory latency of large maps.
+
+Every lookup is a C++20 coroutine (LookupCoroutine) that, before touching memory that is likely not in cache (next search
+midpoint, next tree node), prefetches it and suspends. runInterleavedLookups() keeps a group of lookups in flight and resumes
+them round-robin, so by the time a lookup is resumed its cache line has hopefully arrived while other lookups did their work.
+Unlike batched find (see FlatHashMap::findBatch()), this works also for pointer-chasing structures where the next address
+is known only after the current node has been loaded.
+
+Lookups:
+    -lookupSorted():    branchless binary search over contiguous sorted elements (MapVector, boost::flat_map storage).
+    -lookupStdMap():    walk of std::map red-black tree. Standard library doesn't expose tree nodes, so this relies on
+                        implementation details of libstdc++ and MSVC standard library; BENCH_HAS_STD_MAP_NODE_ACCESS tells
+                        whether it's available. Otherwise lookupStdMap() does plain find() without suspending.
+
+Coroutine frames are allocated from a thread local free list so that frame allocation doesn't dominate the lookup cost.
+
+Requires coroutine support (BENCH_HAS_COROUTINES).
+
+*/
+
+#include <version>
+
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+    #define BENCH_HAS_COROUTINES 1
+#else
+    #define BENCH_HAS_COROUTINES 0
+#endif
+
+#if defined(__GLIBCXX__) || (defined(_MSC_VER) && !defined(_LIBCPP_VERSION))
+    #define BENCH_HAS_STD_MAP_NODE_ACCESS 1
+#else
+    #define BENCH_HAS_STD_MAP_NODE_ACCESS 0
+#endif
+
+#if BENCH_HAS_COROUTINES
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace bench
+{
+
+namespace detail
+{
+    inline void prefetchForLookup(const void* p)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+        __builtin_prefetch(p);
+#endif
+    }
+
+    // Free list of coroutine frames; frames up to maxFrameSize bytes are recycled, bigger ones use global new/delete.
+    class CoroutineFramePool
+    {
+    public:
+        static constexpr size_t maxFrameSize = 256;
+
+        ~CoroutineFramePool()
+        {
+            while (m_pFree)
+            {
+                auto p = m_pFree;
+                m_pFree = p->pNext;
+                ::operator delete(p);
+            }
+        }
+
+        void* allocate(const size_t nSize)
+        {
+            if (nSize > maxFrameSize)
+                return ::operator new(nSize);
+            if (m_pFree)
+            {
+                auto p = m_pFree;
+                m_pFree = p->pNext;
+                return p;
+            }
+            return ::operator new(maxFrameSize);
+        }
+
+        void deallocate(void* p, const size_t nSize)
+        {
+            if (nSize > maxFrameSize)
+            {
+                ::operator delete(p);
+                return;
+            }
+            auto pBlock = static_cast<FreeBlock*>(p);
+            pBlock->pNext = m_pFree;
+            m_pFree = pBlock;
+        }
+
+        static CoroutineFramePool& threadInstance()
+        {
+            thread_local CoroutineFramePool pool;
+            return pool;
+        }
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* pNext;
+        };
+
+        FreeBlock* m_pFree = nullptr;
+    }; // class CoroutineFramePool
+} // namespace detail
+
+// Coroutine of single lookup; result is true if key was found. Lookup starts suspended and is run with resume().
+class LookupCoroutine
+{
+public:
+    struct promise_type
+    {
+        LookupCoroutine get_return_object() { return LookupCoroutine(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(const bool bFound) { m_bFound = bFound; }
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(const size_t nSize) { return detail::CoroutineFramePool::threadInstance().allocate(nSize); }
+        static void operator delete(void* p, const size_t nSize) { detail::CoroutineFramePool::threadInstance().deallocate(p, nSize); }
+
+        bool m_bFound = false;
+    };
+
+    LookupCoroutine() = default;
+    explicit LookupCoroutine(const std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+    LookupCoroutine(LookupCoroutine&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    LookupCoroutine& operator=(LookupCoroutine&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    LookupCoroutine(const LookupCoroutine&) = delete;
+    LookupCoroutine& operator=(const LookupCoroutine&) = delete;
+    ~LookupCoroutine() { reset(); }
+
+    bool isValid() const { return static_cast<bool>(m_handle); }
+    bool done() const    { return m_handle.done(); }
+    void resume()        { m_handle.resume(); }
+    bool isFound() const { return m_handle.promise().m_bFound; }
+
+    void reset()
+    {
+        if (m_handle)
+            m_handle.destroy();
+        m_handle = nullptr;
+    }
+
+private:
+    std::coroutine_handle<promise_type> m_handle;
+}; // class LookupCoroutine
+
+// Awaitable that prefetches given address and suspends the lookup.
+struct PrefetchAndSuspend
+{
+    bool await_ready() const noexcept
+    {
+        detail::prefetchForLookup(m_p);
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    void await_resume() const noexcept {}
+
+    const void* m_p;
+};
+
+// Searches key from sorted unique elements [pFirst, pFirst + nCount) where key of element is keyOf(element).
+// Suspends before every step whose midpoint is at least a cache line away from previous reads.
+template <class T, class Key_T, class KeyFunc_T>
+LookupCoroutine lookupSorted(const T* pFirst, const size_t nCount, const Key_T key, KeyFunc_T keyOf)
+{
+    if (nCount == 0)
+        co_return false;
+    const T* pBase = pFirst;
+    size_t n = nCount;
+    while (n > 1)
+    {
+        const size_t nHalf = n / 2;
+        if (nHalf * sizeof(T) >= 64)
+            co_await PrefetchAndSuspend{ pBase + nHalf };
+        pBase = (keyOf(pBase[nHalf]) < key) ? pBase + nHalf : pBase;
+        n -= nHalf;
+    }
+    const T* p = pBase + (keyOf(*pBase) < key);
+    co_return (p != pFirst + nCount && keyOf(*p) == key);
+}
+
+// Searches key from std::map by walking its tree, suspending before visiting every node.
+template <class Key_T, class Val_T, class Compare_T, class Alloc_T>
+LookupCoroutine lookupStdMap(const std::map<Key_T, Val_T, Compare_T, Alloc_T>& m, const Key_T key)
+{
+#if defined(__GLIBCXX__)
+    using Node = std::_Rb_tree_node<typename std::map<Key_T, Val_T, Compare_T, Alloc_T>::value_type>;
+    const std::_Rb_tree_node_base* pHeader = m.end()._M_node;
+    const std::_Rb_tree_node_base* pNode = pHeader->_M_parent; // Root
+    while (pNode)
+    {
+        co_await PrefetchAndSuspend{ pNode };
+        const auto& nodeKey = static_cast<const Node*>(pNode)->_M_valptr()->first;
+        if (key < nodeKey)
+            pNode = pNode->_M_left;
+        else if (nodeKey < key)
+            pNode = pNode->_M_right;
+        else
+            co_return true;
+    }
+    co_return false;
+#elif BENCH_HAS_STD_MAP_NODE_ACCESS // MSVC
+    const auto pHead = m.end()._Ptr;
+    auto pNode = pHead->_Parent; // Root
+    while (!pNode->_Isnil)
+    {
+        co_await PrefetchAndSuspend{ pNode };
+        const auto& nodeKey = pNode->_Myval.first;
+        if (key < nodeKey)
+            pNode = pNode->_Left;
+        else if (nodeKey < key)
+            pNode = pNode->_Right;
+        else
+            co_return true;
+    }
+    co_return false;
+#else
+    co_return m.find(key) != m.end();
+#endif
+}
+
+// Runs makeLookup(key) for every key in [pKeys, pKeys + nCount) keeping at most nGroupSize lookups in flight and
+// resuming them round-robin. Returns the number of found keys.
+template <class Key_T, class LookupFactory_T>
+size_t runInterleavedLookups(const Key_T* pKeys, const size_t nCount, const size_t nGroupSize, LookupFactory_T&& makeLookup)
+{
+    std::vector<LookupCoroutine> inFlight(std::max<size_t>(1, nGroupSize));
+    size_t nNextKey = 0;
+    size_t nActive = 0;
+    size_t nFound = 0;
+    for (auto& lookup : inFlight)
+    {
+        if (nNextKey == nCount)
+            break;
+        lookup = makeLookup(pKeys[nNextKey++]);
+        lookup.resume(); // Runs until the first prefetch.
+        ++nActive;
+    }
+    while (nActive > 0)
+    {
+        for (auto& lookup : inFlight)
+        {
+            if (!lookup.isValid())
+                continue;
+            if (!lookup.done())
+                lookup.resume();
+            if (!lookup.done())
+                continue;
+            nFound += lookup.isFound();
+            if (nNextKey < nCount)
+            {
+                lookup = makeLookup(pKeys[nNextKey++]);
+                lookup.resume();
+            }
+            else
+            {
+                lookup.reset();
+                --nActive;
+            }
+        }
+    }
+    return nFound;
+}
+
+} // namespace bench
+
+#endif // BENCH_HAS_COROUTINES
@@ -0,0 +1,192 @@
+#pragma once
+
+/*
+
+Lookup key stream generation shared by find benchmarks.
+
+Stream is controlled by KeyStreamParams:
+    -hit ratio:         fraction of lookups that target an existing key, the rest are misses.
+    -Zipf exponent:     0 gives uniform distribution over the working set; s > 0 gives Zipf distribution where the
+                        key of rank r is looked up with probability proportional to 1 / r^s (s around 1 is typical for
+                        real-world hot sets). Ranks are assigned to working set keys in random order, so hot keys are
+                        spread over the key space.
+    -working set size:  number of distinct existing keys that hits are drawn from, chosen randomly from all existing
+                        keys. 0 means all keys.
+
+Streams are meant to be materialized with generateKeyStream() before timing starts so that random number generation is not
+part of the measured lookup time.
+
+Parameters can be given to benchmarks without command line through environment variables BENCHMARK_HIT_RATIO,
+BENCHMARK_ZIPF_EXPONENT and BENCHMARK_WORKING_SET (see keyStreamParamsFromEnvironment()) and to benchmarks with command line
+through options --hit-ratio, --zipf and --working-set (see applyKeyStreamOption()).
+
+Requires C++17.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+struct KeyStreamParams
+{
+    double hitRatio = 1;
+    double zipfExponent = 0;
+    size_t nWorkingSetSize = 0; // 0 means all existing keys.
+};
+
+inline std::string keyStreamParamsDescription(const KeyStreamParams& params)
+{
+    std::ostringstream ostrm;
+    ostrm << "hit ratio " << params.hitRatio << ", zipf " << params.zipfExponent << ", working set ";
+    if (params.nWorkingSetSize == 0)
+        ostrm << "all";
+    else
+        ostrm << params.nWorkingSetSize;
+    return ostrm.str();
+}
+
+// Zipf distribution over [1, n] with exponent s > 0 using rejection-inversion sampling (W. Hormann, G. Derflinger: Rejection-
+// inversion to generate variates from monotone discrete distributions), which needs O(1) memory and setup time regardless of n.
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(const size_t n, const double s)
+        : m_n(static_cast<double>(n))
+        , m_s(s)
+        , m_hIntegralX1(hIntegral(1.5) - 1)
+        , m_hIntegralN(hIntegral(m_n + 0.5))
+        , m_sConst(2 - hIntegralInverse(hIntegral(2.5) - h(2)))
+    {}
+
+    // Returns rank in [1, n].
+    template <class RandEng_T>
+    size_t operator()(RandEng_T& randEng) const
+    {
+        std::uniform_real_distribution<double> uniformDistr(0, 1);
+        for (;;)
+        {
+            const double u = m_hIntegralN + uniformDistr(randEng) * (m_hIntegralX1 - m_hIntegralN);
+            const double x = hIntegralInverse(u);
+            const double k = std::clamp(std::floor(x + 0.5), 1.0, m_n);
+            if (k - x <= m_sConst || u >= hIntegral(k + 0.5) - h(k))
+                return static_cast<size_t>(k);
+        }
+    }
+
+private:
+    // log1p(x) / x and expm1(x) / x with series for small x.
+    static double helper1(const double x) { return (std::abs(x) > 1e-8) ? std::log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x)); }
+    static double helper2(const double x) { return (std::abs(x) > 1e-8) ? std::expm1(x) / x : 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x)); }
+
+    double h(const double x) const { return std::exp(-m_s * std::log(x)); }
+
+    double hIntegral(const double x) const
+    {
+        const double logX = std::log(x);
+        return helper2((1 - m_s) * logX) * logX;
+    }
+
+    double hIntegralInverse(const double x) const
+    {
+        const double t = (std::max)(x * (1 - m_s), -1.0);
+        return std::exp(helper1(t) * x);
+    }
+
+    double m_n;
+    double m_s;
+    double m_hIntegralX1;
+    double m_hIntegralN;
+    double m_sConst;
+}; // class ZipfDistribution
+
+// Returns nLength lookup keys for a container that has nExistingCount keys. Hits are hitKey(i) for existing key index i in
+// [0, nExistingCount) and misses are missKey(randEng), which must return a key that is not in the container.
+template <class Key_T, class RandEng_T, class HitKeyFunc_T, class MissKeyFunc_T>
+std::vector<Key_T> generateKeyStream(const size_t nExistingCount, const size_t nLength, const KeyStreamParams& params, RandEng_T& randEng, HitKeyFunc_T&& hitKey, MissKeyFunc_T&& missKey)
+{
+    std::vector<Key_T> keys;
+    keys.reserve(nLength);
+    const size_t nWorkingSetSize = (params.nWorkingSetSize == 0) ? nExistingCount : (std::min)(params.nWorkingSetSize, nExistingCount);
+    const bool bUniformOverAll = (nWorkingSetSize == nExistingCount && params.zipfExponent <= 0);
+
+    // Working set keys in rank order: first nWorkingSetSize items of a partial Fisher-Yates shuffle.
+    std::vector<size_t> workingSet;
+    if (!bUniformOverAll)
+    {
+        workingSet.resize(nExistingCount);
+        std::iota(workingSet.begin(), workingSet.end(), size_t(0));
+        for (size_t i = 0; i < nWorkingSetSize; ++i)
+            std::swap(workingSet[i], workingSet[std::uniform_int_distribution<size_t>(i, nExistingCount - 1)(randEng)]);
+        workingSet.resize(nWorkingSetSize);
+    }
+
+    std::bernoulli_distribution hitDistr((nWorkingSetSize > 0) ? std::clamp(params.hitRatio, 0.0, 1.0) : 0.0);
+    std::uniform_int_distribution<size_t> uniformDistr(0, (nWorkingSetSize > 0) ? nWorkingSetSize - 1 : 0);
+    std::optional<ZipfDistribution> zipfDistr;
+    if (params.zipfExponent > 0 && nWorkingSetSize > 0)
+        zipfDistr.emplace(nWorkingSetSize, params.zipfExponent);
+
+    for (size_t i = 0; i < nLength; ++i)
+    {
+        if (!hitDistr(randEng))
+        {
+            keys.push_back(missKey(randEng));
+            continue;
+        }
+        const size_t nRank = (zipfDistr) ? (*zipfDistr)(randEng) - 1 : uniformDistr(randEng);
+        keys.push_back(hitKey(bUniformOverAll ? nRank : workingSet[nRank]));
+    }
+    return keys;
+}
+
+// Returns default KeyStreamParams overridden by environment variables BENCHMARK_HIT_RATIO, BENCHMARK_ZIPF_EXPONENT and
+// BENCHMARK_WORKING_SET if set. Used by benchmarks that have no command line, e.g. the gtest-based ones.
+inline KeyStreamParams keyStreamParamsFromEnvironment(KeyStreamParams params = KeyStreamParams())
+{
+    if (const char* psz = std::getenv("BENCHMARK_HIT_RATIO"))
+        params.hitRatio = std::strtod(psz, nullptr);
+    if (const char* psz = std::getenv("BENCHMARK_ZIPF_EXPONENT"))
+        params.zipfExponent = std::strtod(psz, nullptr);
+    if (const char* psz = std::getenv("BENCHMARK_WORKING_SET"))
+        params.nWorkingSetSize = static_cast<size_t>(std::strtod(psz, nullptr));
+    return params;
+}
+
+inline bool isKeyStreamOption(const std::string_view sName)
+{
+    return sName == "--hit-ratio" || sName == "--zipf" || sName == "--working-set";
+}
+
+// Sets key stream option --hit-ratio=<0..1>, --zipf=<exponent> or --working-set=<count> to params. Returns false if value is
+// invalid or sName is not a key stream option.
+inline bool applyKeyStreamOption(KeyStreamParams& params, const std::string_view sName, const std::string& sValue)
+{
+    char* pEnd = nullptr;
+    const double val = std::strtod(sValue.c_str(), &pEnd);
+    if (pEnd == sValue.c_str() || *pEnd != '\0' || !(val >= 0))
+        return false;
+    if (sName == "--hit-ratio" && val <= 1)
+        params.hitRatio = val;
+    else if (sName == "--zipf")
+        params.zipfExponent = val;
+    else if (sName == "--working-set" && std::floor(val) == val)
+        params.nWorkingSetSize = static_cast<size_t>(val);
+    else
+        return false;
+    return true;
+}
+
+} // namespace bench
@@ -0,0 +1,274 @@
+#pragma once
+
+/*
+
+Per-operation latency measurement for timed loops: shows tail latency, e.g. reallocation spikes of not reserved vector maps
+and rehash spikes of hash maps, that total time of a loop hides.
+
+    -CycleClock:        reads time stamp counter (rdtsc) on x86 and std::chrono::steady_clock elsewhere. Tick rate of rdtsc is
+                        calibrated once against steady_clock (about 20 ms on first use, so call ticksPerSecond() before
+                        timing starts; LatencySampler constructor does it).
+    -LatencyHistogram:  HDR-style log-linear histogram: values below 2^subBucketBits are recorded exactly and every larger
+                        power-of-two range is split to 2^subBucketBits buckets, so relative error of percentiles is at most
+                        1 / 2^subBucketBits (1.6 %) over the whole uint64 range with fixed memory (about 30 KB). Maximum
+                        is exact.
+    -LatencySampler:    wraps operations of a timed loop: measure(func) calls func and times every k-th call, others only
+                        cost a counter decrement. Sampling interval 0 means disabled; loops should then run without the
+                        sampler at all, see below.
+
+Typical use:
+
+    bench::LatencySampler sampler(nSampleInterval);
+    if (sampler.enabled())
+        for (...) sampler.measure([&] { return cont.find(key); });
+    else
+        for (...) cont.find(key);
+    const auto percentiles = sampler.percentiles();
+
+Note that time of the whole loop includes the overhead of sampled timer reads, so total times of latency runs are not
+directly comparable to runs without sampling.
+
+Sampling interval can be given to benchmarks without command line through environment variable BENCHMARK_LATENCY_SAMPLE
+(see latencySampleIntervalFromEnvironment()).
+
+Requires C++17.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define BENCH_HAS_RDTSC 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#else
+    #define BENCH_HAS_RDTSC 0
+#endif
+
+namespace bench
+{
+
+class CycleClock
+{
+public:
+    static uint64_t now()
+    {
+#if BENCH_HAS_RDTSC
+        _mm_lfence(); // Keeps rdtsc from executing before earlier instructions have completed.
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static double ticksPerSecond()
+    {
+        static const double s_ticksPerSecond = calibrate();
+        return s_ticksPerSecond;
+    }
+
+    static double ticksToNanoseconds(const uint64_t nTicks)
+    {
+        return static_cast<double>(nTicks) * 1e9 / ticksPerSecond();
+    }
+
+private:
+    static double calibrate()
+    {
+#if BENCH_HAS_RDTSC
+        using Clock = std::chrono::steady_clock;
+        const auto startTime = Clock::now();
+        const auto nStartTicks = now();
+        auto endTime = startTime;
+        while (endTime - startTime < std::chrono::milliseconds(20))
+            endTime = Clock::now();
+        const auto nEndTicks = now();
+        return static_cast<double>(nEndTicks - nStartTicks) / std::chrono::duration<double>(endTime - startTime).count();
+#else
+        return 1e9;
+#endif
+    }
+}; // class CycleClock
+
+class LatencyHistogram
+{
+public:
+    static constexpr unsigned subBucketBits = 6;
+    static constexpr size_t subBucketCount = size_t(1) << subBucketBits;
+    static constexpr size_t bucketCount = (64 - subBucketBits + 1) * subBucketCount;
+
+    LatencyHistogram()
+        : m_counts(bucketCount, 0)
+    {}
+
+    void record(const uint64_t nValue)
+    {
+        ++m_counts[bucketIndex(nValue)];
+        ++m_nCount;
+        m_nMax = (std::max)(m_nMax, nValue);
+    }
+
+    void merge(const LatencyHistogram& other)
+    {
+        for (size_t i = 0; i < bucketCount; ++i)
+            m_counts[i] += other.m_counts[i];
+        m_nCount += other.m_nCount;
+        m_nMax = (std::max)(m_nMax, other.m_nMax);
+    }
+
+    // Returns value at or below which fraction q (in [0, 1]) of recorded values are, i.e. the highest value of bucket where
+    // cumulative count reaches q * count(). Returns 0 if nothing has been recorded.
+    uint64_t percentile(const double q) const
+    {
+        if (m_nCount == 0)
+            return 0;
+        const auto nTarget = (std::max)(uint64_t(1), static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(m_nCount) + 0.5));
+        uint64_t nCumulative = 0;
+        for (size_t i = 0; i < bucketCount; ++i)
+        {
+            nCumulative += m_counts[i];
+            if (nCumulative >= nTarget)
+                return (std::min)(bucketHighestValue(i), m_nMax);
+        }
+        return m_nMax;
+    }
+
+    uint64_t count() const  { return m_nCount; }
+    uint64_t max() const    { return m_nMax; }
+
+    static size_t bucketIndex(const uint64_t nValue)
+    {
+        if (nValue < subBucketCount)
+            return static_cast<size_t>(nValue);
+        const auto nMsb = highestBitIndex(nValue);
+        const auto nShift = nMsb - subBucketBits;
+        return (static_cast<size_t>(nShift) + 1) * subBucketCount + static_cast<size_t>((nValue >> nShift) - subBucketCount);
+    }
+
+    static uint64_t bucketHighestValue(const size_t nIndex)
+    {
+        if (nIndex < subBucketCount)
+            return nIndex;
+        const auto nShift = static_cast<unsigned>(nIndex / subBucketCount - 1);
+        const auto nLowest = (uint64_t(subBucketCount) + nIndex % subBucketCount) << nShift;
+        return nLowest + ((uint64_t(1) << nShift) - 1);
+    }
+
+private:
+    static unsigned highestBitIndex(uint64_t nValue)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(nValue));
+#else
+        unsigned n = 0;
+        while (nValue >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+
+    std::vector<uint64_t> m_counts;
+    uint64_t m_nCount = 0;
+    uint64_t m_nMax = 0;
+}; // class LatencyHistogram
+
+// Latency summary in nanoseconds. Trivially copyable so that it can be part of results sent between processes.
+struct LatencyPercentiles
+{
+    uint64_t nSampleCount = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+};
+
+inline LatencyPercentiles latencyPercentiles(const LatencyHistogram& histogram)
+{
+    LatencyPercentiles rv;
+    rv.nSampleCount = histogram.count();
+    rv.p50 = CycleClock::ticksToNanoseconds(histogram.percentile(0.5));
+    rv.p99 = CycleClock::ticksToNanoseconds(histogram.percentile(0.99));
+    rv.p999 = CycleClock::ticksToNanoseconds(histogram.percentile(0.999));
+    rv.max = CycleClock::ticksToNanoseconds(histogram.max());
+    return rv;
+}
+
+inline std::string latencyPercentilesDescription(const LatencyPercentiles& percentiles)
+{
+    std::ostringstream ostrm;
+    ostrm << "p50 " << percentiles.p50 << " ns, p99 " << percentiles.p99 << " ns, p99.9 " << percentiles.p999
+          << " ns, max " << percentiles.max << " ns (" << percentiles.nSampleCount << " samples)";
+    return ostrm.str();
+}
+
+class LatencySampler
+{
+public:
+    // Times every nSampleInterval'th operation, 0 disables sampling.
+    explicit LatencySampler(const size_t nSampleInterval)
+        : m_nInterval(nSampleInterval)
+        , m_nCountdown(nSampleInterval)
+    {
+        if (enabled())
+            CycleClock::ticksPerSecond(); // Calibrates outside of timed loop.
+    }
+
+    bool enabled() const { return m_nInterval != 0; }
+
+    // Calls func() and returns its return value with the same type, i.e. references are returned as references to the
+    // object func() refers to; every k-th call is timed.
+    template <class Func_T>
+    decltype(auto) measure(Func_T&& func)
+    {
+        if (--m_nCountdown != 0)
+            return func();
+        m_nCountdown = m_nInterval;
+        const auto nStart = CycleClock::now();
+        if constexpr (std::is_void_v<decltype(func())>)
+        {
+            func();
+            m_histogram.record(CycleClock::now() - nStart);
+        }
+        else
+        {
+            decltype(auto) rv = func();
+            m_histogram.record(CycleClock::now() - nStart);
+            if constexpr (std::is_rvalue_reference_v<decltype(rv)>)
+                return std::move(rv);
+            else
+                return rv;
+        }
+    }
+
+    const LatencyHistogram& histogram() const   { return m_histogram; }
+    LatencyPercentiles percentiles() const      { return latencyPercentiles(m_histogram); }
+
+private:
+    size_t m_nInterval;
+    size_t m_nCountdown;
+    LatencyHistogram m_histogram;
+}; // class LatencySampler
+
+// Returns sampling interval from environment variable BENCHMARK_LATENCY_SAMPLE, 0 (disabled) if not set or invalid.
+inline size_t latencySampleIntervalFromEnvironment()
+{
+    const char* psz = std::getenv("BENCHMARK_LATENCY_SAMPLE");
+    if (!psz)
+        return 0;
+    const auto val = std::strtod(psz, nullptr);
+    return (val >= 1) ? static_cast<size_t>(val) : 0;
+}
+
+} // namespace bench
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+
+Helpers shared by the standalone map benchmarks (mapSimpleInsert, shardedMapThroughput):
+
+    -TypeList:          compile-time list of types, used for registering benchmarked maps.
+    -prettyTypeName():  readable name of a map type for output rows; falls back to typeid name for types without
+                        specialization. Benchmarks can add specializations for their own types in namespace bench.
+    -mapId():           id of map type used in --map command line filters.
+    -generateKey():     random int key in [keyMin, keyMax], the key distribution of the insert benchmark of
+                        dfgTestContMapVectorPerformance.cpp.
+
+Requires dfglib and Boost (MapVector and flat_map specializations) and C++17.
+
+*/
+
+#include <map>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <boost/container/flat_map.hpp>
+
+#include <dfg/cont/MapVector.hpp>
+#include <dfg/rand.hpp>
+
+namespace bench
+{
+
+template <class... Types_T> struct TypeList {};
+
+template <class T> std::string prettyTypeName()                                        { return typeid(T).name(); }
+template <> inline std::string prettyTypeName<std::map<int, int>>()                   { return "std::map<int,int>"; }
+template <> inline std::string prettyTypeName<std::unordered_map<int, int>>()         { return "std::unordered_map<int, int>"; }
+template <> inline std::string prettyTypeName<boost::container::flat_map<int, int>>() { return "boost::flat_map<int, int>"; }
+template <> inline std::string prettyTypeName<dfg::cont::MapVectorSoA<int, int>>()    { return "MapVectorSoA<int, int>"; }
+template <> inline std::string prettyTypeName<dfg::cont::MapVectorAoS<int, int>>()    { return "MapVectorAoS<int, int>"; }
+
+template <class T> std::string mapId();
+template <> inline std::string mapId<std::map<int, int>>()                   { return "map"; }
+template <> inline std::string mapId<std::unordered_map<int, int>>()         { return "unordered_map"; }
+template <> inline std::string mapId<boost::container::flat_map<int, int>>() { return "boost_flat_map"; }
+template <> inline std::string mapId<dfg::cont::MapVectorSoA<int, int>>()    { return "MapVectorSoA"; }
+template <> inline std::string mapId<dfg::cont::MapVectorAoS<int, int>>()    { return "MapVectorAoS"; }
+
+constexpr int keyMin = -10000000;
+constexpr int keyMax = 10000000;
+
+template <class RandEng_T>
+int generateKey(RandEng_T& re)
+{
+    return DFG_MODULE_NS(rand)::rand<int>(re, keyMin, keyMax);
+}
+
+} // namespace bench
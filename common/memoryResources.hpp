@@ -0,0 +1,296 @@
+#pragma once
+
+/*
+
+Memory resources for the allocator dimension of map benchmarks.
+
+AllocatorKind lists the benchmarked std::pmr configurations:
+    -defaultResource:   std::pmr::get_default_resource(), i.e. new/delete through memory_resource interface
+    -pool:              std::pmr::unsynchronized_pool_resource
+    -monotonic:         std::pmr::monotonic_buffer_resource (deallocate is no-op, everything is released on destruction)
+    -nodePool:          FixedSizeNodePoolResource below
+    -arena:             ArenaResource below; containers are discarded by releasing the arena without running their destructor
+                        (see ResourceBackedContainer) so destruction cost does not depend on element count.
+
+Requires <memory_resource>, which is not available e.g. in libc++ before version 16; BENCH_HAS_PMR tells whether it is.
+
+*/
+
+#include <version>
+
+#if defined(__cpp_lib_memory_resource)
+    #define BENCH_HAS_PMR 1
+#else
+    #define BENCH_HAS_PMR 0
+#endif
+
+namespace bench
+{
+
+enum class AllocatorKind
+{
+    defaultResource,
+    pool,
+    monotonic,
+    nodePool,
+    arena
+};
+
+constexpr AllocatorKind allAllocatorKinds[] = { AllocatorKind::defaultResource, AllocatorKind::pool, AllocatorKind::monotonic, AllocatorKind::nodePool, AllocatorKind::arena };
+
+// Id used in command line filters.
+inline const char* allocatorKindId(const AllocatorKind kind)
+{
+    switch (kind)
+    {
+        case AllocatorKind::defaultResource: return "default";
+        case AllocatorKind::pool:            return "pool";
+        case AllocatorKind::monotonic:       return "monotonic";
+        case AllocatorKind::nodePool:        return "node_pool";
+        case AllocatorKind::arena:           return "arena";
+        default:                             return "";
+    }
+}
+
+inline const char* allocatorKindDescription(const AllocatorKind kind)
+{
+    switch (kind)
+    {
+        case AllocatorKind::defaultResource: return "default_resource";
+        case AllocatorKind::pool:            return "unsynchronized_pool_resource";
+        case AllocatorKind::monotonic:       return "monotonic_buffer_resource";
+        case AllocatorKind::nodePool:        return "FixedSizeNodePoolResource";
+        case AllocatorKind::arena:           return "ArenaResource, bulk release";
+        default:                             return "";
+    }
+}
+
+} // namespace bench
+
+#if BENCH_HAS_PMR
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace bench
+{
+
+// Single-threaded pool for fixed size blocks, intended for nodes of node-based containers.
+// The pooled block size is learned from the first allocation request of at most maxBlockSize bytes (in node-based maps
+// that is the node allocation); all requests of other sizes, like bucket arrays of unordered_map, are forwarded to upstream.
+// Blocks are carved from geometrically growing chunks and freed blocks are kept in an intrusive free list.
+// All chunks are returned to upstream on destruction.
+class FixedSizeNodePoolResource : public std::pmr::memory_resource
+{
+public:
+    static constexpr size_t maxBlockSize = 256;
+    static constexpr size_t blockAlignment = alignof(std::max_align_t);
+
+    explicit FixedSizeNodePoolResource(std::pmr::memory_resource* pUpstream = std::pmr::get_default_resource())
+        : m_pUpstream(pUpstream)
+    {}
+
+    ~FixedSizeNodePoolResource() override
+    {
+        release();
+    }
+
+    FixedSizeNodePoolResource(const FixedSizeNodePoolResource&) = delete;
+    FixedSizeNodePoolResource& operator=(const FixedSizeNodePoolResource&) = delete;
+
+    // Returns all chunks to upstream; blocks given out before become invalid.
+    void release()
+    {
+        for (const auto& chunk : m_chunks)
+            m_pUpstream->deallocate(chunk.first, chunk.second, blockAlignment);
+        m_chunks.clear();
+        m_pFreeList = nullptr;
+        m_pCurrent = nullptr;
+        m_pCurrentEnd = nullptr;
+        m_nNextChunkBlockCount = initialChunkBlockCount;
+    }
+
+    size_t blockSize() const { return m_nBlockSize; }
+
+private:
+    static constexpr size_t initialChunkBlockCount = 256;
+    static constexpr size_t maxChunkBlockCount = size_t(1) << 20;
+
+    struct FreeBlock
+    {
+        FreeBlock* pNext;
+    };
+
+    static size_t roundedSize(const size_t nBytes)
+    {
+        const auto nSize = std::max(nBytes, sizeof(FreeBlock));
+        return (nSize + blockAlignment - 1) / blockAlignment * blockAlignment;
+    }
+
+    bool isPooled(const size_t nBytes, const size_t nAlignment) const
+    {
+        return nAlignment <= blockAlignment && m_nBlockSize != 0 && roundedSize(nBytes) == m_nBlockSize;
+    }
+
+    void* do_allocate(const size_t nBytes, const size_t nAlignment) override
+    {
+        if (m_nBlockSize == 0 && nBytes <= maxBlockSize && nAlignment <= blockAlignment)
+            m_nBlockSize = roundedSize(nBytes);
+        if (!isPooled(nBytes, nAlignment))
+            return m_pUpstream->allocate(nBytes, nAlignment);
+        if (m_pFreeList)
+        {
+            auto p = m_pFreeList;
+            m_pFreeList = p->pNext;
+            return p;
+        }
+        if (m_pCurrent == m_pCurrentEnd)
+            allocateChunk();
+        auto p = m_pCurrent;
+        m_pCurrent += m_nBlockSize;
+        return p;
+    }
+
+    void do_deallocate(void* p, const size_t nBytes, const size_t nAlignment) override
+    {
+        if (!isPooled(nBytes, nAlignment))
+        {
+            m_pUpstream->deallocate(p, nBytes, nAlignment);
+            return;
+        }
+        auto pBlock = static_cast<FreeBlock*>(p);
+        pBlock->pNext = m_pFreeList;
+        m_pFreeList = pBlock;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    void allocateChunk()
+    {
+        const auto nChunkBytes = m_nNextChunkBlockCount * m_nBlockSize;
+        auto p = static_cast<std::byte*>(m_pUpstream->allocate(nChunkBytes, blockAlignment));
+        m_chunks.emplace_back(p, nChunkBytes);
+        m_pCurrent = p;
+        m_pCurrentEnd = p + nChunkBytes;
+        m_nNextChunkBlockCount = std::min(2 * m_nNextChunkBlockCount, maxChunkBlockCount);
+    }
+
+    std::pmr::memory_resource* m_pUpstream;
+    size_t m_nBlockSize = 0;
+    FreeBlock* m_pFreeList = nullptr;
+    std::byte* m_pCurrent = nullptr;
+    std::byte* m_pCurrentEnd = nullptr;
+    size_t m_nNextChunkBlockCount = initialChunkBlockCount;
+    std::vector<std::pair<std::byte*, size_t>> m_chunks;
+}; // class FixedSizeNodePoolResource
+
+// Resettable arena for containers that are built and then thrown away as a whole. Allocation is bump allocation from
+// geometrically growing chunks (starting from initialChunkSize bytes), deallocation is a no-op and reset() returns all
+// chunks to upstream at once.
+class ArenaResource : public std::pmr::monotonic_buffer_resource
+{
+public:
+    static constexpr size_t initialChunkSize = 64 * 1024;
+
+    explicit ArenaResource(std::pmr::memory_resource* pUpstream = std::pmr::get_default_resource())
+        : monotonic_buffer_resource(initialChunkSize, pUpstream)
+    {}
+
+    // Releases all memory; everything allocated from the arena becomes invalid.
+    void reset() { release(); }
+}; // class ArenaResource
+
+// Returns new resource of given kind, or null for defaultResource in which case std::pmr::get_default_resource() should be used.
+inline std::unique_ptr<std::pmr::memory_resource> createMemoryResource(const AllocatorKind kind)
+{
+    switch (kind)
+    {
+        case AllocatorKind::pool:       return std::make_unique<std::pmr::unsynchronized_pool_resource>();
+        case AllocatorKind::monotonic:  return std::make_unique<std::pmr::monotonic_buffer_resource>();
+        case AllocatorKind::nodePool:   return std::make_unique<FixedSizeNodePoolResource>();
+        case AllocatorKind::arena:      return std::make_unique<ArenaResource>();
+        default:                        return nullptr;
+    }
+}
+
+inline std::pmr::memory_resource* resourceOrDefault(std::pmr::memory_resource* pResource)
+{
+    return (pResource) ? pResource : std::pmr::get_default_resource();
+}
+
+inline const char* memoryResourceDescription(std::pmr::memory_resource* pResource)
+{
+    if (pResource == std::pmr::get_default_resource())
+        return allocatorKindDescription(AllocatorKind::defaultResource);
+    if (dynamic_cast<std::pmr::unsynchronized_pool_resource*>(pResource))
+        return allocatorKindDescription(AllocatorKind::pool);
+    if (dynamic_cast<ArenaResource*>(pResource)) // Checked before monotonic_buffer_resource as ArenaResource derives from it.
+        return allocatorKindDescription(AllocatorKind::arena);
+    if (dynamic_cast<std::pmr::monotonic_buffer_resource*>(pResource))
+        return allocatorKindDescription(AllocatorKind::monotonic);
+    if (dynamic_cast<FixedSizeNodePoolResource*>(pResource))
+        return allocatorKindDescription(AllocatorKind::nodePool);
+    return "unknown_resource";
+}
+
+template <class Cont_T>
+constexpr bool usesPolymorphicAllocator()
+{
+    if constexpr (requires { typename Cont_T::allocator_type; })
+        return std::is_same_v<typename Cont_T::allocator_type, std::pmr::polymorphic_allocator<typename Cont_T::value_type>>;
+    else
+        return false;
+}
+
+// Owns a container together with the memory resource it allocates from; the resource is destroyed after the container.
+// Containers that don't use polymorphic allocator are default constructed and AllocatorKind is ignored.
+// With AllocatorKind::arena and trivially destructible elements, the container destructor is not run at all: all memory
+// the container refers to is owned by the arena, so destruction reduces to releasing the arena chunks.
+template <class Cont_T>
+class ResourceBackedContainer
+{
+public:
+    explicit ResourceBackedContainer(const AllocatorKind kind)
+    {
+        if constexpr (usesPolymorphicAllocator<Cont_T>())
+        {
+            m_spResource = createMemoryResource(kind);
+            m_bSkipDestructor = (kind == AllocatorKind::arena && std::is_trivially_destructible_v<typename Cont_T::value_type>);
+            new (&m_storage) Cont_T(resourceOrDefault(m_spResource.get()));
+        }
+        else
+            new (&m_storage) Cont_T();
+    }
+
+    ~ResourceBackedContainer()
+    {
+        if (!m_bSkipDestructor)
+            get().~Cont_T();
+    }
+
+    ResourceBackedContainer(const ResourceBackedContainer&) = delete;
+    ResourceBackedContainer& operator=(const ResourceBackedContainer&) = delete;
+
+    Cont_T& get() { return *std::launder(reinterpret_cast<Cont_T*>(&m_storage)); }
+
+    // True if destruction releases the arena instead of destroying elements one by one.
+    bool isDiscardedByArenaRelease() const { return m_bSkipDestructor; }
+
+private:
+    std::unique_ptr<std::pmr::memory_resource> m_spResource; // Declared first so that it's destroyed last.
+    alignas(Cont_T) std::byte m_storage[sizeof(Cont_T)];
+    bool m_bSkipDestructor = false;
+}; // class ResourceBackedContainer
+
+} // namespace bench
+
+#endif // BENCH_HAS_PMR
@@ -0,0 +1,206 @@
+#pragma once
+
+/*
+
+Parallel bulk build of sorted unique storage, e.g. for MapVector push-sort-unique build: elements are first pushed
+unsorted to storage and then sortAndUniqueByKey() sorts them by key and removes duplicates.
+
+Result is identical to stable sort followed by std::unique, i.e. from elements with equal keys the one pushed first is kept.
+
+Sorting is an in-repo LSD radix sort for integer keys using std::thread: every pass computes per-thread digit histograms
+of consecutive chunks and then each thread scatters its chunk, which keeps the sort stable. Passes where all keys have the
+same digit are skipped. Duplicate removal uses the same chunks: every thread removes duplicates within its chunk, skipping
+leading elements that continue the key run of the preceding chunk, and the unique ranges are then compacted in parallel.
+std::execution based sorting is not used as with libstdc++ it requires linking to TBB, which the benchmark builds don't do.
+
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace bench
+{
+
+inline size_t defaultSortThreadCount()
+{
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+namespace detail
+{
+    // Calls func(i) for i in [0, nCount), each in its own thread; func(0) is run in the calling thread.
+    template <class Func_T>
+    void runInThreads(const size_t nCount, Func_T&& func)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(nCount);
+        for (size_t i = 1; i < nCount; ++i)
+            threads.emplace_back([&func, i]() { func(i); });
+        func(0);
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // Returns thread count for parallel passes over nCount elements; small inputs are not worth the thread overhead.
+    inline size_t effectiveThreadCount(const size_t nThreadCount, const size_t nCount)
+    {
+        return std::max<size_t>(1, std::min(nThreadCount, nCount / (size_t(1) << 16)));
+    }
+
+    // Maps integer key to unsigned integer with the same ordering.
+    template <class Key_T>
+    auto toRadixKey(const Key_T key)
+    {
+        using UnsignedKey = std::make_unsigned_t<Key_T>;
+        auto nKey = static_cast<UnsignedKey>(key);
+        if constexpr (std::is_signed_v<Key_T>)
+            nKey ^= UnsignedKey(1) << (std::numeric_limits<UnsignedKey>::digits - 1);
+        return nKey;
+    }
+} // namespace detail
+
+// Stable LSD radix sort of [first, last) by integer key given by keyOf(element). T must be copy assignable and default constructible.
+template <class T, class KeyFunc_T>
+void parallelRadixSortByKey(T* const pFirst, const size_t nCount, KeyFunc_T keyOf, size_t nThreadCount = defaultSortThreadCount())
+{
+    using Key = std::remove_cv_t<std::remove_reference_t<decltype(keyOf(*pFirst))>>;
+    static_assert(std::is_integral_v<Key>, "parallelRadixSortByKey() requires integer keys");
+    constexpr size_t nDigitBits = 8;
+    constexpr size_t nBucketCount = size_t(1) << nDigitBits;
+    constexpr size_t nPassCount = sizeof(Key) * 8 / nDigitBits;
+
+    nThreadCount = detail::effectiveThreadCount(nThreadCount, nCount);
+    const auto chunkBegin = [&](const size_t nThread) { return nCount * nThread / nThreadCount; };
+
+    std::vector<T> buffer(nCount);
+    T* pSrc = pFirst;
+    T* pDst = buffer.data();
+    std::vector<std::array<size_t, nBucketCount>> histograms(nThreadCount);
+    for (size_t nPass = 0; nPass < nPassCount; ++nPass)
+    {
+        const auto nShift = nPass * nDigitBits;
+        const auto digitOf = [&](const T& item) { return static_cast<size_t>((detail::toRadixKey(keyOf(item)) >> nShift) & (nBucketCount - 1)); };
+
+        detail::runInThreads(nThreadCount, [&](const size_t nThread)
+        {
+            auto& histogram = histograms[nThread];
+            histogram.fill(0);
+            for (size_t i = chunkBegin(nThread), nEnd = chunkBegin(nThread + 1); i < nEnd; ++i)
+                ++histogram[digitOf(pSrc[i])];
+        });
+
+        // Offsets are assigned bucket by bucket and within bucket in thread (=chunk) order, which makes the scatter stable.
+        size_t nOffset = 0;
+        bool bSingleBucket = false;
+        for (size_t nBucket = 0; nBucket < nBucketCount; ++nBucket)
+        {
+            size_t nBucketSize = 0;
+            for (size_t nThread = 0; nThread < nThreadCount; ++nThread)
+            {
+                const auto nThreadBucketSize = histograms[nThread][nBucket];
+                histograms[nThread][nBucket] = nOffset;
+                nOffset += nThreadBucketSize;
+                nBucketSize += nThreadBucketSize;
+            }
+            bSingleBucket = bSingleBucket || (nBucketSize == nCount);
+        }
+        if (bSingleBucket)
+            continue; // All keys have the same digit in this pass so order wouldn't change.
+
+        detail::runInThreads(nThreadCount, [&](const size_t nThread)
+        {
+            auto& offsets = histograms[nThread];
+            for (size_t i = chunkBegin(nThread), nEnd = chunkBegin(nThread + 1); i < nEnd; ++i)
+                pDst[offsets[digitOf(pSrc[i])]++] = pSrc[i];
+        });
+        std::swap(pSrc, pDst);
+    }
+    if (pSrc != pFirst)
+    {
+        detail::runInThreads(nThreadCount, [&](const size_t nThread)
+        {
+            std::copy(pSrc + chunkBegin(nThread), pSrc + chunkBegin(nThread + 1), pFirst + chunkBegin(nThread));
+        });
+    }
+}
+
+// Removes from key-sorted [pFirst, pFirst + nCount) every element whose key equals the key of the preceding element, moving
+// the remaining ones to the beginning like std::unique. Returns the number of remaining elements. T must be move assignable
+// and default constructible.
+template <class T, class KeyFunc_T>
+size_t parallelUniqueByKey(T* const pFirst, const size_t nCount, KeyFunc_T keyOf, size_t nThreadCount = defaultSortThreadCount())
+{
+    using Key = std::remove_cv_t<std::remove_reference_t<decltype(keyOf(*pFirst))>>;
+    const auto keyEqual = [&](const T& left, const T& right) { return keyOf(left) == keyOf(right); };
+
+    nThreadCount = detail::effectiveThreadCount(nThreadCount, nCount);
+    if (nThreadCount == 1)
+        return static_cast<size_t>(std::unique(pFirst, pFirst + nCount, keyEqual) - pFirst);
+    const auto chunkBegin = [&](const size_t nThread) { return nCount * nThread / nThreadCount; };
+
+    // Chunks are deduplicated in place, so keys preceding chunk boundaries are read before that.
+    std::vector<Key> precedingKeys(nThreadCount);
+    for (size_t nThread = 1; nThread < nThreadCount; ++nThread)
+        precedingKeys[nThread] = keyOf(pFirst[chunkBegin(nThread) - 1]);
+
+    std::vector<size_t> uniqueBegins(nThreadCount);
+    std::vector<size_t> uniqueCounts(nThreadCount);
+    detail::runInThreads(nThreadCount, [&](const size_t nThread)
+    {
+        auto pChunkFirst = pFirst + chunkBegin(nThread);
+        const auto pChunkLast = pFirst + chunkBegin(nThread + 1);
+        // Elements continuing key run of the preceding chunk are duplicates of an element kept there.
+        if (nThread != 0)
+        {
+            while (pChunkFirst != pChunkLast && keyOf(*pChunkFirst) == precedingKeys[nThread])
+                ++pChunkFirst;
+        }
+        uniqueBegins[nThread] = static_cast<size_t>(pChunkFirst - pFirst);
+        uniqueCounts[nThread] = static_cast<size_t>(std::unique(pChunkFirst, pChunkLast, keyEqual) - pChunkFirst);
+    });
+
+    std::vector<size_t> destOffsets(nThreadCount);
+    size_t nUniqueCount = 0;
+    for (size_t nThread = 0; nThread < nThreadCount; ++nThread)
+    {
+        destOffsets[nThread] = nUniqueCount;
+        nUniqueCount += uniqueCounts[nThread];
+    }
+
+    // Unique range of chunk 0 is already in place. Others are compacted through buffer as destination range of a chunk may
+    // overlap source range of the preceding chunk.
+    const auto nInPlaceCount = uniqueCounts[0];
+    std::vector<T> buffer(nUniqueCount - nInPlaceCount);
+    detail::runInThreads(nThreadCount, [&](const size_t nThread)
+    {
+        if (nThread == 0)
+            return;
+        const auto pSrc = pFirst + uniqueBegins[nThread];
+        std::move(pSrc, pSrc + uniqueCounts[nThread], buffer.data() + destOffsets[nThread] - nInPlaceCount);
+    });
+    const auto bufferChunkBegin = [&](const size_t nThread) { return buffer.size() * nThread / nThreadCount; };
+    detail::runInThreads(nThreadCount, [&](const size_t nThread)
+    {
+        std::move(buffer.data() + bufferChunkBegin(nThread), buffer.data() + bufferChunkBegin(nThread + 1), pFirst + nInPlaceCount + bufferChunkBegin(nThread));
+    });
+    return nUniqueCount;
+}
+
+// Sorts contiguous storage (e.g. std::vector or MapVectorAoS storage) by keyOf(element) and removes elements with duplicate
+// keys so that the first pushed element of every key remains.
+template <class Cont_T, class KeyFunc_T>
+void sortAndUniqueByKey(Cont_T& storage, KeyFunc_T keyOf)
+{
+    parallelRadixSortByKey(storage.data(), storage.size(), keyOf);
+    const auto nUniqueCount = parallelUniqueByKey(storage.data(), storage.size(), keyOf);
+    storage.erase(storage.begin() + static_cast<std::ptrdiff_t>(nUniqueCount), storage.end());
+}
+
+} // namespace bench
@@ -0,0 +1,212 @@
+#pragma once
+
+/*
+
+Hardware performance counters for benchmark timed regions.
+
+Counters are read through Linux perf_event_open(): each counter is opened separately (instead of a single
+perf group) so that kernel can multiplex them when there are more counters than PMU registers; values are
+scaled by time_enabled / time_running. Counters that can't be opened (non-Linux platform, unsupported event,
+perf_event_paranoid restrictions, running in VM without PMU etc.) are simply reported as unavailable so callers
+can leave corresponding output columns empty.
+
+Typical usage:
+    bench::PerfCounters counters;
+    counters.start();
+    <timed region>
+    const auto values = counters.stop();
+    if (values.isAvailable(bench::PerfCounterId::cycles))
+        std::cout << values.perOperation(bench::PerfCounterId::cycles, nOpCount);
+
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #define BENCH_HAS_PERF_EVENT_OPEN 1
+#else
+    #define BENCH_HAS_PERF_EVENT_OPEN 0
+#endif
+
+namespace bench
+{
+
+enum class PerfCounterId
+{
+    cycles,
+    instructions,
+    l1dMisses,
+    llcMisses,
+    dtlbMisses,
+    branchMisses,
+    count // Number of counters, not a counter.
+};
+
+constexpr size_t perfCounterCount = static_cast<size_t>(PerfCounterId::count);
+
+// Names for per operation output columns, in PerfCounterId order.
+inline const char* perfCounterColumnName(const PerfCounterId id)
+{
+    switch (id)
+    {
+        case PerfCounterId::cycles:         return "cycles/op";
+        case PerfCounterId::instructions:   return "instructions/op";
+        case PerfCounterId::l1dMisses:      return "L1D misses/op";
+        case PerfCounterId::llcMisses:      return "LLC misses/op";
+        case PerfCounterId::dtlbMisses:     return "dTLB misses/op";
+        case PerfCounterId::branchMisses:   return "branch misses/op";
+        default:                            return "";
+    }
+}
+
+// Returns true if environment variable BENCHMARK_PERF_COUNTERS is set to non-zero value. Used by benchmarks that have no
+// command line options to make counter capture opt-in.
+inline bool perfCountersRequestedByEnvironment()
+{
+    const char* psz = std::getenv("BENCHMARK_PERF_COUNTERS");
+    return psz != nullptr && *psz != '\0' && std::strcmp(psz, "0") != 0;
+}
+
+// Counter values of one measured region. Trivially copyable so that it can be passed between processes as raw bytes.
+struct PerfCounterValues
+{
+    bool isAvailable(const PerfCounterId id) const { return m_available[static_cast<size_t>(id)]; }
+    double value(const PerfCounterId id) const     { return m_values[static_cast<size_t>(id)]; }
+    double perOperation(const PerfCounterId id, const double nOpCount) const { return (nOpCount > 0) ? value(id) / nOpCount : 0; }
+
+    bool anyAvailable() const
+    {
+        for (const auto b : m_available)
+        {
+            if (b)
+                return true;
+        }
+        return false;
+    }
+
+    std::array<double, perfCounterCount> m_values{};
+    std::array<bool, perfCounterCount> m_available{};
+};
+
+class PerfCounters
+{
+public:
+    // If bEnabled is false, no counters are opened and all values are reported as unavailable.
+    explicit PerfCounters(const bool bEnabled = true)
+    {
+        m_fds.fill(-1);
+#if BENCH_HAS_PERF_EVENT_OPEN
+        if (!bEnabled)
+            return;
+        for (size_t i = 0; i < perfCounterCount; ++i)
+            m_fds[i] = openCounter(static_cast<PerfCounterId>(i));
+#else
+        (void)bEnabled;
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#if BENCH_HAS_PERF_EVENT_OPEN
+        for (const auto fd : m_fds)
+        {
+            if (fd != -1)
+                close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool anyAvailable() const
+    {
+        for (const auto fd : m_fds)
+        {
+            if (fd != -1)
+                return true;
+        }
+        return false;
+    }
+
+    // Resets and enables all available counters.
+    void start()
+    {
+#if BENCH_HAS_PERF_EVENT_OPEN
+        for (const auto fd : m_fds)
+        {
+            if (fd == -1)
+                continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Disables counters and returns values accumulated since start().
+    PerfCounterValues stop()
+    {
+        PerfCounterValues values;
+#if BENCH_HAS_PERF_EVENT_OPEN
+        for (const auto fd : m_fds)
+        {
+            if (fd != -1)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (size_t i = 0; i < perfCounterCount; ++i)
+        {
+            if (m_fds[i] == -1)
+                continue;
+            std::uint64_t buffer[3] = {}; // value, time_enabled, time_running
+            if (read(m_fds[i], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)) || buffer[2] == 0)
+                continue; // Counter never got scheduled, leaving as unavailable.
+            values.m_values[i] = static_cast<double>(buffer[0]) * (static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]));
+            values.m_available[i] = true;
+        }
+#endif
+        return values;
+    }
+
+private:
+#if BENCH_HAS_PERF_EVENT_OPEN
+    static int openCounter(const PerfCounterId id)
+    {
+        const auto cacheConfig = [](const std::uint64_t cache, const std::uint64_t op, const std::uint64_t result)
+        {
+            return cache | (op << 8) | (result << 16);
+        };
+
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (id)
+        {
+            case PerfCounterId::cycles:       attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+            case PerfCounterId::instructions: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+            case PerfCounterId::l1dMisses:    attr.type = PERF_TYPE_HW_CACHE; attr.config = cacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS); break;
+            case PerfCounterId::llcMisses:    attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+            case PerfCounterId::dtlbMisses:   attr.type = PERF_TYPE_HW_CACHE; attr.config = cacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS); break;
+            case PerfCounterId::branchMisses: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+            default: return -1;
+        }
+        const auto fd = syscall(SYS_perf_event_open, &attr, 0 /*this process*/, -1 /*any cpu*/, -1 /*no group*/, 0 /*flags*/);
+        return (fd >= 0) ? static_cast<int>(fd) : -1;
+    }
+#endif
+
+    std::array<int, perfCounterCount> m_fds;
+}; // class PerfCounters
+
+} // namespace bench
@@ -0,0 +1,218 @@
+#pragma once
+
+/*
+
+Adaptive repetition of benchmark iterations: instead of a fixed iteration count, runs warmup iterations whose results are not
+used and then measured iterations until the median of every result has converged or a limit is reached.
+
+    -RepetitionPolicy:      warmup count, minimum and maximum measured count, target relative half-width of the 95 %
+                            confidence interval of the median and time budget in seconds (0 means no budget, only the
+                            maximum count limits). Default: 1 warmup, 3 - 20 measured iterations, 2 % target, 30 s budget.
+    -RepetitionController:  drives the iteration loop, see below. Time budget is measured from construction, i.e. it
+                            includes warmups.
+    -summarizeSamples():    min, median, MAD (median absolute deviation, unscaled) and distribution-free confidence interval
+                            of the median from order statistics. With less than 6 samples the interval is [min, max], so the
+                            minimum count should be at least 3 for the interval to say anything.
+
+Typical use, where relativeCi() returns the largest relative CI half-width over the results measured so far:
+
+    for (bench::RepetitionController repetitions(policy); !repetitions.done(); repetitions.advance(relativeCi()))
+    {
+        const auto sColumnName = repetitions.iterationLabel("Time"); // "Warmup#0", "Time#0", "Time#1", ...
+        ...
+    }
+
+Policy can be given to benchmarks without command line through environment variable BENCHMARK_REPETITIONS (see
+repetitionPolicyFromEnvironment()) and to benchmarks with command line with the same "W/MIN/MAX/CI/BUDGET" format through
+parseRepetitionPolicy(). For example "0/5/5" gives the former fixed 5 iterations without warmup.
+
+Requires C++17.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <cstdlib>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+struct SampleSummary
+{
+    size_t nCount = 0;
+    double min = 0;
+    double median = 0;
+    double mad = 0;
+    double ciLow = 0;
+    double ciHigh = 0;
+
+    // Returns half-width of confidence interval relative to median, 0 if there are no samples.
+    double relativeCiHalfWidth() const
+    {
+        return (nCount == 0 || median == 0) ? 0 : (ciHigh - ciLow) / (2 * std::abs(median));
+    }
+};
+
+namespace detail
+{
+
+// Returns median of sorted, non-empty values.
+inline double sortedMedian(const std::vector<double>& sorted)
+{
+    const auto n = sorted.size();
+    return (n % 2 == 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
+
+} // namespace detail
+
+inline SampleSummary summarizeSamples(std::vector<double> samples)
+{
+    SampleSummary rv;
+    rv.nCount = samples.size();
+    if (samples.empty())
+        return rv;
+    std::sort(samples.begin(), samples.end());
+    rv.min = samples.front();
+    rv.median = detail::sortedMedian(samples);
+
+    // 95 % confidence interval of the median: ranks n/2 -+ 1.96 * sqrt(n) / 2 (1-based) from normal approximation of
+    // the binomial distribution, doesn't assume anything about distribution of the samples.
+    const auto n = static_cast<double>(samples.size());
+    const auto halfWidth = 1.96 * std::sqrt(n) / 2;
+    const auto nLowRank = (std::max)(1.0, std::round(n / 2 - halfWidth));
+    const auto nHighRank = (std::min)(n, std::round(1 + n / 2 + halfWidth));
+    rv.ciLow = samples[static_cast<size_t>(nLowRank) - 1];
+    rv.ciHigh = samples[static_cast<size_t>(nHighRank) - 1];
+
+    for (auto& val : samples)
+        val = std::abs(val - rv.median);
+    std::sort(samples.begin(), samples.end());
+    rv.mad = detail::sortedMedian(samples);
+    return rv;
+}
+
+struct RepetitionPolicy
+{
+    size_t nWarmupCount = 1;
+    size_t nMinCount = 3;
+    size_t nMaxCount = 20;
+    double targetRelativeCi = 0.02; // Target for SampleSummary::relativeCiHalfWidth().
+    double timeBudgetSeconds = 30;  // 0 means no time budget.
+};
+
+inline std::string repetitionPolicyDescription(const RepetitionPolicy& policy)
+{
+    std::ostringstream ostrm;
+    ostrm << policy.nWarmupCount << " warmup, " << policy.nMinCount << " - " << policy.nMaxCount << " measured, target CI "
+          << 100 * policy.targetRelativeCi << " %, budget ";
+    if (policy.timeBudgetSeconds > 0)
+        ostrm << policy.timeBudgetSeconds << " s";
+    else
+        ostrm << "none";
+    return ostrm.str();
+}
+
+// Parses policy from "W/MIN/MAX/CI/BUDGET" (e.g. "1/3/20/0.02/30"); trailing fields can be omitted and keep their default
+// values. Returns std::nullopt if string is invalid or if MIN is 0 or greater than MAX.
+inline std::optional<RepetitionPolicy> parseRepetitionPolicy(const std::string& s)
+{
+    RepetitionPolicy policy;
+    double vals[5] = { double(policy.nWarmupCount), double(policy.nMinCount), double(policy.nMaxCount), policy.targetRelativeCi, policy.timeBudgetSeconds };
+    size_t nFieldCount = 0;
+    for (const char* p = s.c_str(); ; ++p)
+    {
+        if (nFieldCount == std::size(vals))
+            return std::nullopt;
+        char* pEnd = nullptr;
+        vals[nFieldCount++] = std::strtod(p, &pEnd);
+        if (pEnd == p || (*pEnd != '\0' && *pEnd != '/'))
+            return std::nullopt;
+        if (*pEnd == '\0')
+            break;
+        p = pEnd;
+    }
+    if (nFieldCount < 3)
+        vals[2] = (std::max)(vals[2], vals[1]); // Giving only MIN shouldn't make it invalid because of default MAX.
+    for (size_t i = 0; i < 3; ++i)
+    {
+        if (!(vals[i] >= 0) || std::floor(vals[i]) != vals[i])
+            return std::nullopt;
+    }
+    if (vals[1] < 1 || vals[1] > vals[2] || !(vals[3] >= 0) || !(vals[4] >= 0))
+        return std::nullopt;
+    policy.nWarmupCount = static_cast<size_t>(vals[0]);
+    policy.nMinCount = static_cast<size_t>(vals[1]);
+    policy.nMaxCount = static_cast<size_t>(vals[2]);
+    policy.targetRelativeCi = vals[3];
+    policy.timeBudgetSeconds = vals[4];
+    return policy;
+}
+
+// Returns default policy overridden by environment variable BENCHMARK_REPETITIONS if it is set and valid. Used by benchmarks
+// that have no command line, e.g. the gtest-based ones.
+inline RepetitionPolicy repetitionPolicyFromEnvironment()
+{
+    if (const char* psz = std::getenv("BENCHMARK_REPETITIONS"))
+    {
+        if (const auto policy = parseRepetitionPolicy(psz))
+            return *policy;
+    }
+    return RepetitionPolicy();
+}
+
+class RepetitionController
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit RepetitionController(const RepetitionPolicy& policy)
+        : m_policy(policy)
+        , m_startTime(Clock::now())
+    {}
+
+    bool done() const               { return m_bDone; }
+    bool isWarmup() const           { return m_nIteration < m_policy.nWarmupCount; }
+    // Index of the current iteration counting warmups, i.e. 0 on the first iteration.
+    size_t iterationIndex() const   { return m_nIteration; }
+    size_t measuredCount() const    { return (isWarmup()) ? 0 : m_nIteration - m_policy.nWarmupCount; }
+
+    // Returns "Warmup#<i>" for warmup iterations and "<prefix>#<i>" for measured ones, i counting from 0 in both.
+    std::string iterationLabel(const char* pszMeasuredPrefix) const
+    {
+        return (isWarmup()) ? "Warmup#" + std::to_string(m_nIteration) : pszMeasuredPrefix + ("#" + std::to_string(measuredCount()));
+    }
+
+    // Called after every iteration with the largest SampleSummary::relativeCiHalfWidth() of measured results (ignored after
+    // warmup iterations). Marks repetition done when maximum count is reached or when minimum count is reached and either
+    // the relative CI is within target or time budget has been used.
+    void advance(const double relativeCiHalfWidth)
+    {
+        const bool bWasWarmup = isWarmup();
+        ++m_nIteration;
+        if (bWasWarmup)
+            return;
+        const auto nMeasured = measuredCount();
+        if (nMeasured >= m_policy.nMaxCount)
+            m_bDone = true;
+        else if (nMeasured >= m_policy.nMinCount)
+        {
+            const auto elapsedSeconds = std::chrono::duration<double>(Clock::now() - m_startTime).count();
+            m_bDone = relativeCiHalfWidth <= m_policy.targetRelativeCi || (m_policy.timeBudgetSeconds > 0 && elapsedSeconds >= m_policy.timeBudgetSeconds);
+        }
+    }
+
+private:
+    RepetitionPolicy m_policy;
+    Clock::time_point m_startTime;
+    size_t m_nIteration = 0;
+    bool m_bDone = false;
+}; // class RepetitionController
+
+} // namespace bench
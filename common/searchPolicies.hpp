@@ -0,0 +1,263 @@
+#pragma once
+
+/*
+
+Search policies for find over contiguous key arrays, e.g. key storage of MapVectorSoA.
+
+Every policy is a stateless struct with
+    static const char* name();
+    template <class Key_T> static size_t find(const Key_T* pKeys, size_t nCount, const Key_T& key);
+where find() returns index of key or nCount if not found. All policies except LinearSimdSearch require keys to be sorted
+and unique. Policies may also have batch find
+    template <class Key_T> static void findBatch(const Key_T* pKeys, size_t nCount, const Key_T* pQueries, size_t nQueryCount, size_t* pResults);
+that interleaves searches of several keys; findBatch() below uses it when available and calls find() for every key otherwise.
+
+Policies:
+    -LowerBoundSearch:          std::lower_bound, i.e. what sorted MapVector uses
+    -BranchlessBinarySearch:    binary search where the step is a conditional move instead of a branch, prefetching
+                                both possible next midpoints so that the memory access of the next step is already on its way.
+                                Batch find advances up to batchSize searches one level at a time and prefetches the next
+                                midpoint of each, so that cache misses of different keys overlap.
+    -InterpolationSearch:       estimates the position from key value; for arithmetic keys that are roughly uniformly
+                                distributed. Falls back to binary search if interpolation doesn't converge quickly.
+    -KarySimdSearch:            k-ary search that compares key against k separators at once (k = 4 with SSE2, 8 with AVX2
+                                for 32-bit integers; separators are compared one by one for other key types) and finishes
+                                with simdFindIndex() once the range is small.
+    -LinearSimdSearch:          simdFindIndex(), works also for unsorted keys.
+
+*/
+
+#include "simdFind.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace bench
+{
+
+namespace detail
+{
+    inline void prefetch(const void* p)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        _mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+        __builtin_prefetch(p);
+#endif
+    }
+} // namespace detail
+
+struct LowerBoundSearch
+{
+    static const char* name() { return "lower_bound"; }
+
+    template <class Key_T>
+    static size_t find(const Key_T* pKeys, const size_t nCount, const Key_T& key)
+    {
+        const auto p = std::lower_bound(pKeys, pKeys + nCount, key);
+        return (p != pKeys + nCount && *p == key) ? static_cast<size_t>(p - pKeys) : nCount;
+    }
+}; // struct LowerBoundSearch
+
+struct BranchlessBinarySearch
+{
+    static const char* name() { return "branchless binary with prefetch"; }
+
+    template <class Key_T>
+    static size_t find(const Key_T* pKeys, const size_t nCount, const Key_T& key)
+    {
+        if (nCount == 0)
+            return 0;
+        const Key_T* pBase = pKeys;
+        size_t n = nCount;
+        while (n > 1)
+        {
+            const size_t nHalf = n / 2;
+            // Next midpoint is either pBase[nHalf / 2] or pBase[nHalf + nHalf / 2] depending on the comparison below.
+            detail::prefetch(pBase + nHalf / 2);
+            detail::prefetch(pBase + nHalf + nHalf / 2);
+            pBase = (pBase[nHalf] < key) ? pBase + nHalf : pBase;
+            n -= nHalf;
+        }
+        const auto nIndex = static_cast<size_t>(pBase - pKeys) + (*pBase < key);
+        return (nIndex < nCount && pKeys[nIndex] == key) ? nIndex : nCount;
+    }
+
+    // Number of searches that are interleaved in findBatch().
+    static constexpr size_t batchSize = 32;
+
+    template <class Key_T>
+    static void findBatch(const Key_T* pKeys, const size_t nCount, const Key_T* pQueries, const size_t nQueryCount, size_t* pResults)
+    {
+        if (nCount == 0)
+        {
+            std::fill(pResults, pResults + nQueryCount, nCount);
+            return;
+        }
+        const Key_T* bases[batchSize];
+        for (size_t nFirst = 0; nFirst < nQueryCount; nFirst += batchSize)
+        {
+            const auto nBatch = std::min(batchSize, nQueryCount - nFirst);
+            const auto pBatchQueries = pQueries + nFirst;
+            std::fill(bases, bases + nBatch, pKeys);
+            // All searches have the same range length at every level, only bases differ.
+            for (size_t n = nCount; n > 1; )
+            {
+                const size_t nHalf = n / 2;
+                const size_t nNextHalf = (n - nHalf) / 2;
+                for (size_t j = 0; j < nBatch; ++j)
+                {
+                    const auto pBase = (bases[j][nHalf] < pBatchQueries[j]) ? bases[j] + nHalf : bases[j];
+                    bases[j] = pBase;
+                    detail::prefetch(pBase + nNextHalf);
+                }
+                n -= nHalf;
+            }
+            for (size_t j = 0; j < nBatch; ++j)
+            {
+                const auto nIndex = static_cast<size_t>(bases[j] - pKeys) + (*bases[j] < pBatchQueries[j]);
+                pResults[nFirst + j] = (nIndex < nCount && pKeys[nIndex] == pBatchQueries[j]) ? nIndex : nCount;
+            }
+        }
+    }
+}; // struct BranchlessBinarySearch
+
+struct InterpolationSearch
+{
+    static const char* name() { return "interpolation"; }
+
+    // After this many interpolation steps the rest is searched with binary search, which bounds the worst case
+    // (e.g. clustered keys) to O(log n) in addition to the interpolation steps.
+    static constexpr int maxInterpolationSteps = 8;
+
+    template <class Key_T>
+    static size_t find(const Key_T* pKeys, const size_t nCount, const Key_T& key)
+    {
+        if constexpr (!std::is_arithmetic_v<Key_T>)
+            return LowerBoundSearch::find(pKeys, nCount, key);
+        else
+        {
+            if (nCount == 0)
+                return 0;
+            size_t nLow = 0;
+            size_t nHigh = nCount - 1; // Inclusive
+            for (int nStep = 0; nStep < maxInterpolationSteps; ++nStep)
+            {
+                if (key < pKeys[nLow] || pKeys[nHigh] < key)
+                    return nCount;
+                if (nHigh - nLow < 8)
+                    break;
+                // Calculated in floating point to avoid overflow with wide key ranges.
+                const double fraction = (static_cast<double>(key) - static_cast<double>(pKeys[nLow]))
+                                      / (static_cast<double>(pKeys[nHigh]) - static_cast<double>(pKeys[nLow]));
+                const auto nPos = nLow + std::min(static_cast<size_t>(fraction * static_cast<double>(nHigh - nLow)), nHigh - nLow);
+                if (pKeys[nPos] == key)
+                    return nPos;
+                if (pKeys[nPos] < key)
+                    nLow = nPos + 1;
+                else
+                {
+                    if (nPos == nLow)
+                        return nCount;
+                    nHigh = nPos - 1;
+                }
+            }
+            const auto nIndex = LowerBoundSearch::find(pKeys + nLow, nHigh - nLow + 1, key);
+            return (nIndex != nHigh - nLow + 1) ? nLow + nIndex : nCount;
+        }
+    }
+}; // struct InterpolationSearch
+
+struct KarySimdSearch
+{
+    static const char* name()
+    {
+        return (BENCH_SIMD_FIND_AVX2) ? "k-ary SIMD (k=8, AVX2)" : ((BENCH_SIMD_FIND_SSE2) ? "k-ary SIMD (k=4, SSE2)" : "k-ary (k=4, scalar)");
+    }
+
+    static constexpr size_t k = (BENCH_SIMD_FIND_AVX2) ? 8 : 4;
+    // Ranges of at most this many keys are searched linearly with simdFindIndex().
+    static constexpr size_t linearSearchThreshold = 64;
+
+    template <class Key_T>
+    static size_t find(const Key_T* pKeys, const size_t nCount, const Key_T& key)
+    {
+        size_t nFirst = 0;
+        size_t n = nCount;
+        while (n > linearSearchThreshold)
+        {
+            // Range is divided to k + 1 segments; separator j is the last key of segment j. Since keys are sorted and
+            // unique, the number of separators less than key is the index of the segment that can contain key.
+            const size_t nStep = n / (k + 1);
+            Key_T separators[k];
+            for (size_t j = 0; j < k; ++j)
+                separators[j] = pKeys[nFirst + (j + 1) * nStep - 1];
+            const size_t nSegment = countLessThan(separators, key);
+            nFirst += nSegment * nStep;
+            n = (nSegment == k) ? n - k * nStep : nStep;
+        }
+        const auto nIndex = simdFindIndex(pKeys + nFirst, n, key);
+        return (nIndex != n) ? nFirst + nIndex : nCount;
+    }
+
+private:
+    template <class Key_T>
+    static size_t countLessThan(const Key_T (&separators)[k], const Key_T& key)
+    {
+#if BENCH_SIMD_FIND_SSE2
+        if constexpr (std::is_integral_v<Key_T> && std::is_signed_v<Key_T> && sizeof(Key_T) == 4)
+        {
+    #if BENCH_SIMD_FIND_AVX2
+            const auto lt = _mm256_cmpgt_epi32(_mm256_set1_epi32(key), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(separators)));
+            return static_cast<size_t>(std::popcount(static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(lt)))));
+    #else
+            const auto lt = _mm_cmpgt_epi32(_mm_set1_epi32(key), _mm_loadu_si128(reinterpret_cast<const __m128i*>(separators)));
+            return static_cast<size_t>(std::popcount(static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(lt)))));
+    #endif
+        }
+        else
+#endif
+        {
+            size_t nLess = 0;
+            for (const auto& separator : separators)
+                nLess += (separator < key);
+            return nLess;
+        }
+    }
+}; // struct KarySimdSearch
+
+struct LinearSimdSearch
+{
+    static const char* name()
+    {
+        return (BENCH_SIMD_FIND_AVX2) ? "SIMD linear (AVX2)" : ((BENCH_SIMD_FIND_SSE2) ? "SIMD linear (SSE)" : "linear (scalar fallback)");
+    }
+
+    template <class Key_T>
+    static size_t find(const Key_T* pKeys, const size_t nCount, const Key_T& key)
+    {
+        return simdFindIndex(pKeys, nCount, key);
+    }
+}; // struct LinearSimdSearch
+
+// Writes result of SearchPolicy_T::find() for every key in [pQueries, pQueries + nQueryCount) to pResults, using
+// SearchPolicy_T::findBatch() if the policy has it.
+template <class SearchPolicy_T, class Key_T>
+void findBatch(const Key_T* pKeys, const size_t nCount, const Key_T* pQueries, const size_t nQueryCount, size_t* pResults)
+{
+    if constexpr (requires { SearchPolicy_T::findBatch(pKeys, nCount, pQueries, nQueryCount, pResults); })
+        SearchPolicy_T::findBatch(pKeys, nCount, pQueries, nQueryCount, pResults);
+    else
+    {
+        for (size_t i = 0; i < nQueryCount; ++i)
+            pResults[i] = SearchPolicy_T::find(pKeys, nCount, pQueries[i]);
+    }
+}
+
+} // namespace bench
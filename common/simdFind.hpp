@@ -0,0 +1,180 @@
+#pragma once
+
+/*
+
+Vectorized linear search over contiguous key arrays, e.g. the key storage of an unsorted MapVectorSoA.
+
+simdFindIndex() compares 4, 8 or 16 keys at a time (depending on key size and available instruction set) and uses
+movemask to locate the first hit. Supported key types are 32- and 64-bit integers, float and double:
+    -32-bit integers and float: SSE2, AVX2 if compiled with it (e.g. -mavx2 or /arch:AVX2)
+    -64-bit integers: SSE4.1 or AVX2 if compiled with them
+    -double: SSE2, AVX2 if compiled with it
+Other key types and non-x86 targets use a scalar loop. Result is always identical to std::find().
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__)
+    #define BENCH_SIMD_FIND_AVX2 1
+#else
+    #define BENCH_SIMD_FIND_AVX2 0
+#endif
+
+#if defined(__SSE4_1__) || BENCH_SIMD_FIND_AVX2
+    #define BENCH_SIMD_FIND_SSE41 1
+#else
+    #define BENCH_SIMD_FIND_SSE41 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define BENCH_SIMD_FIND_SSE2 1
+    #include <immintrin.h>
+#else
+    #define BENCH_SIMD_FIND_SSE2 0
+#endif
+
+#if BENCH_SIMD_FIND_SSE2 && defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace bench
+{
+
+namespace detail
+{
+    inline unsigned countTrailingZeros(const unsigned int nMask)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long nIndex;
+        _BitScanForward(&nIndex, nMask);
+        return static_cast<unsigned>(nIndex);
+#else
+        return static_cast<unsigned>(__builtin_ctz(nMask));
+#endif
+    }
+
+    template <class Key_T>
+    size_t scalarFindIndex(const Key_T* pKeys, const size_t nFirst, const size_t nCount, const Key_T& key)
+    {
+        for (size_t i = nFirst; i < nCount; ++i)
+        {
+            if (pKeys[i] == key)
+                return i;
+        }
+        return nCount;
+    }
+} // namespace detail
+
+// Returns true if simdFindIndex() has vectorized implementation for Key_T in current build.
+template <class Key_T>
+constexpr bool hasSimdFind()
+{
+#if BENCH_SIMD_FIND_SSE2
+    if constexpr (std::is_integral_v<Key_T> && sizeof(Key_T) == 4)
+        return true;
+    else if constexpr (std::is_integral_v<Key_T> && sizeof(Key_T) == 8)
+        return BENCH_SIMD_FIND_SSE41;
+    else
+        return std::is_same_v<Key_T, float> || std::is_same_v<Key_T, double>;
+#else
+    return false;
+#endif
+}
+
+// Returns index of the first element in [pKeys, pKeys + nCount) that equals to key, or nCount if there is no such element.
+template <class Key_T>
+size_t simdFindIndex(const Key_T* pKeys, const size_t nCount, const Key_T& key)
+{
+    size_t i = 0;
+#if BENCH_SIMD_FIND_SSE2
+    using namespace detail;
+    // Checks two vectors per iteration so that a single branch covers twice as many keys.
+    // nMask has one bit per byte, so bit index is divided by key size to get element offset.
+    #define BENCH_TEMP_SIMD_FIND_LOOP(VEC_T, LOAD, SPLAT, CMPEQ, MOVEMASK)   \
+        {                                                                       \
+            constexpr size_t nPerVec = sizeof(VEC_T) / sizeof(Key_T);           \
+            const auto needle = SPLAT;                                          \
+            for (; i + 2 * nPerVec <= nCount; i += 2 * nPerVec)                 \
+            {                                                                   \
+                const auto eq0 = CMPEQ(LOAD(pKeys + i), needle);                \
+                const auto eq1 = CMPEQ(LOAD(pKeys + i + nPerVec), needle);      \
+                const auto nMask0 = static_cast<unsigned int>(MOVEMASK(eq0));   \
+                const auto nMask1 = static_cast<unsigned int>(MOVEMASK(eq1));   \
+                if ((nMask0 | nMask1) != 0)                                     \
+                {                                                               \
+                    return (nMask0 != 0)                                        \
+                        ? i + countTrailingZeros(nMask0) / sizeof(Key_T)        \
+                        : i + nPerVec + countTrailingZeros(nMask1) / sizeof(Key_T); \
+                }                                                               \
+            }                                                                   \
+        }
+
+    #define BENCH_TEMP_LOAD_SI128(p) _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))
+    #define BENCH_TEMP_LOAD_SI256(p) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+    #define BENCH_TEMP_LOAD_PS128(p) _mm_castps_si128(_mm_loadu_ps(p))
+    #define BENCH_TEMP_LOAD_PD128(p) _mm_castpd_si128(_mm_loadu_pd(p))
+    #define BENCH_TEMP_LOAD_PS256(p) _mm256_castps_si256(_mm256_loadu_ps(p))
+    #define BENCH_TEMP_LOAD_PD256(p) _mm256_castpd_si256(_mm256_loadu_pd(p))
+    // Floating point keys are compared as floating point values (not as bit patterns) so that e.g. -0.0 == 0.0 like in std::find().
+    #define BENCH_TEMP_CMPEQ_PS128(a, b) _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)))
+    #define BENCH_TEMP_CMPEQ_PD128(a, b) _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)))
+    #define BENCH_TEMP_CMPEQ_PS256(a, b) _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ))
+    #define BENCH_TEMP_CMPEQ_PD256(a, b) _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ))
+
+    if constexpr (std::is_integral_v<Key_T> && sizeof(Key_T) == 4)
+    {
+        std::int32_t nKey;
+        std::memcpy(&nKey, &key, sizeof(nKey));
+#if BENCH_SIMD_FIND_AVX2
+        BENCH_TEMP_SIMD_FIND_LOOP(__m256i, BENCH_TEMP_LOAD_SI256, _mm256_set1_epi32(nKey), _mm256_cmpeq_epi32, _mm256_movemask_epi8)
+#endif
+        BENCH_TEMP_SIMD_FIND_LOOP(__m128i, BENCH_TEMP_LOAD_SI128, _mm_set1_epi32(nKey), _mm_cmpeq_epi32, _mm_movemask_epi8)
+    }
+    else if constexpr (std::is_integral_v<Key_T> && sizeof(Key_T) == 8)
+    {
+        std::int64_t nKey;
+        std::memcpy(&nKey, &key, sizeof(nKey));
+        (void)nKey;
+#if BENCH_SIMD_FIND_AVX2
+        BENCH_TEMP_SIMD_FIND_LOOP(__m256i, BENCH_TEMP_LOAD_SI256, _mm256_set1_epi64x(nKey), _mm256_cmpeq_epi64, _mm256_movemask_epi8)
+#endif
+#if BENCH_SIMD_FIND_SSE41
+        BENCH_TEMP_SIMD_FIND_LOOP(__m128i, BENCH_TEMP_LOAD_SI128, _mm_set1_epi64x(nKey), _mm_cmpeq_epi64, _mm_movemask_epi8)
+#endif
+    }
+    else if constexpr (std::is_same_v<Key_T, float>)
+    {
+#if BENCH_SIMD_FIND_AVX2
+        BENCH_TEMP_SIMD_FIND_LOOP(__m256i, BENCH_TEMP_LOAD_PS256, _mm256_castps_si256(_mm256_set1_ps(key)), BENCH_TEMP_CMPEQ_PS256, _mm256_movemask_epi8)
+#endif
+        BENCH_TEMP_SIMD_FIND_LOOP(__m128i, BENCH_TEMP_LOAD_PS128, _mm_castps_si128(_mm_set1_ps(key)), BENCH_TEMP_CMPEQ_PS128, _mm_movemask_epi8)
+    }
+    else if constexpr (std::is_same_v<Key_T, double>)
+    {
+#if BENCH_SIMD_FIND_AVX2
+        BENCH_TEMP_SIMD_FIND_LOOP(__m256i, BENCH_TEMP_LOAD_PD256, _mm256_castpd_si256(_mm256_set1_pd(key)), BENCH_TEMP_CMPEQ_PD256, _mm256_movemask_epi8)
+#endif
+        BENCH_TEMP_SIMD_FIND_LOOP(__m128i, BENCH_TEMP_LOAD_PD128, _mm_castpd_si128(_mm_set1_pd(key)), BENCH_TEMP_CMPEQ_PD128, _mm_movemask_epi8)
+    }
+
+    #undef BENCH_TEMP_CMPEQ_PD256
+    #undef BENCH_TEMP_CMPEQ_PS256
+    #undef BENCH_TEMP_CMPEQ_PD128
+    #undef BENCH_TEMP_CMPEQ_PS128
+    #undef BENCH_TEMP_LOAD_PD256
+    #undef BENCH_TEMP_LOAD_PS256
+    #undef BENCH_TEMP_LOAD_PD128
+    #undef BENCH_TEMP_LOAD_PS128
+    #undef BENCH_TEMP_LOAD_SI256
+    #undef BENCH_TEMP_LOAD_SI128
+    #undef BENCH_TEMP_SIMD_FIND_LOOP
+#endif // BENCH_SIMD_FIND_SSE2
+    // Remaining tail (and everything if there's no vectorized implementation for Key_T).
+    return detail::scalarFindIndex(pKeys, i, nCount, key);
+}
+
+} // namespace bench
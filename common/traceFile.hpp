@@ -0,0 +1,420 @@
+#pragma once
+
+/*
+
+Binary operation trace format for replaying captured workloads, e.g. key and operation traces from production, against
+benchmarked containers.
+
+File layout (native byte order, checked through endianness marker in header):
+    -TraceFileHeader (32 bytes): magic "BNCHTRCE", format version, record size, record count and endianness marker.
+    -TraceRecord array (24 bytes each): operation, insert position (used by insertAt only), key and value.
+
+Files are read with TraceView, which memory-maps the file and exposes the records in place without copying or parsing,
+so traces of hundreds of millions of operations can be replayed without loading them to memory first. Replay should be
+preceded by prefault() so that page faults of the mapping are not part of timed region. On platforms without memory
+mapping support the file is read to memory instead.
+
+Files are written with TraceWriter; see traceConvert/traceConvert.cpp for converting text files to this format.
+
+replayTrace() is the replay driver: it calls handler.onInsert(key, value), handler.onFind(key), handler.onErase(key),
+handler.onInsertAt(position, key, value) or handler.onUpdate(key, value) for every record and returns the number of
+onFind() calls that returned true.
+
+Functions throw std::runtime_error if file can't be opened, read or written, if it's not a valid trace file or if replayed
+record has unknown operation code.
+
+Requires C++17.
+
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+    #define BENCH_HAS_MMAP 1
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #define BENCH_HAS_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #define BENCH_HAS_MMAP 0
+#endif
+
+namespace bench
+{
+
+enum class TraceOp : uint32_t
+{
+    insert      = 1,    // Inserts (key, value) to map.
+    find        = 2,    // Finds key from map.
+    erase       = 3,    // Erases key from map.
+    insertAt    = 4,    // Inserts value before element at position of a sequence (e.g. vector insert benchmark).
+    update      = 5     // Sets value of existing key, no effect if key is not in map.
+};
+
+inline const char* traceOpName(const TraceOp op)
+{
+    switch (op)
+    {
+        case TraceOp::insert:   return "insert";
+        case TraceOp::find:     return "find";
+        case TraceOp::erase:    return "erase";
+        case TraceOp::insertAt: return "insertAt";
+        case TraceOp::update:   return "update";
+    }
+    return "unknown";
+}
+
+inline bool isKnownTraceOp(const TraceOp op)
+{
+    return op >= TraceOp::insert && op <= TraceOp::update;
+}
+
+struct TraceRecord
+{
+    TraceOp m_op;
+    uint32_t m_nPosition;
+    int64_t m_nKey;
+    int64_t m_nValue;
+};
+
+static_assert(sizeof(TraceRecord) == 24 && std::is_trivially_copyable_v<TraceRecord>, "TraceRecord must have fixed layout");
+
+namespace detail
+{
+    [[noreturn]] inline void throwUnknownTraceOp(const TraceRecord& record, const size_t nRecordIndex)
+    {
+        throw std::runtime_error("Unknown trace operation code " + std::to_string(static_cast<uint32_t>(record.m_op))
+                                 + " in record " + std::to_string(nRecordIndex));
+    }
+} // namespace detail
+
+struct TraceFileHeader
+{
+    static constexpr char magic[8] = { 'B', 'N', 'C', 'H', 'T', 'R', 'C', 'E' };
+    static constexpr uint32_t currentVersion = 1;
+    static constexpr uint32_t endianMarker = 0x01020304;
+
+    char m_magic[8];
+    uint32_t m_nVersion;
+    uint32_t m_nRecordSize;
+    uint64_t m_nRecordCount;
+    uint32_t m_nEndianMarker;
+    uint32_t m_nReserved;
+};
+
+static_assert(sizeof(TraceFileHeader) == 32, "TraceFileHeader must have fixed layout");
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& sPath)
+    {
+#if defined(_WIN32)
+        m_hFile = ::CreateFileA(sPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Unable to open '" + sPath + "'");
+        LARGE_INTEGER fileSize;
+        if (!::GetFileSizeEx(m_hFile, &fileSize))
+        {
+            close();
+            throw std::runtime_error("Unable to get size of '" + sPath + "'");
+        }
+        m_nSize = static_cast<size_t>(fileSize.QuadPart);
+        if (m_nSize == 0)
+            return;
+        m_hMapping = ::CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        m_pData = (m_hMapping) ? static_cast<const std::byte*>(::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (!m_pData)
+        {
+            close();
+            throw std::runtime_error("Unable to map '" + sPath + "'");
+        }
+#elif BENCH_HAS_MMAP
+        const int fd = ::open(sPath.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Unable to open '" + sPath + "'");
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Unable to get size of '" + sPath + "'");
+        }
+        m_nSize = static_cast<size_t>(fileStat.st_size);
+        if (m_nSize > 0)
+        {
+            void* p = ::mmap(nullptr, m_nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                ::madvise(p, m_nSize, MADV_SEQUENTIAL);
+                m_pData = static_cast<const std::byte*>(p);
+            }
+        }
+        ::close(fd); // Mapping stays valid after closing the descriptor.
+        if (m_nSize > 0 && !m_pData)
+            throw std::runtime_error("Unable to map '" + sPath + "'");
+#else
+        std::ifstream istrm(sPath, std::ios::binary | std::ios::ate);
+        if (!istrm)
+            throw std::runtime_error("Unable to open '" + sPath + "'");
+        m_nSize = static_cast<size_t>(istrm.tellg());
+        m_buffer.resize(m_nSize);
+        istrm.seekg(0);
+        if (!istrm.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_nSize)))
+            throw std::runtime_error("Unable to read '" + sPath + "'");
+        m_pData = m_buffer.data();
+#endif
+    }
+
+    MappedFile(MappedFile&& other) noexcept
+    {
+        swap(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        MappedFile temp(std::move(other));
+        swap(temp);
+        return *this;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    void swap(MappedFile& other) noexcept
+    {
+        std::swap(m_pData, other.m_pData);
+        std::swap(m_nSize, other.m_nSize);
+#if defined(_WIN32)
+        std::swap(m_hFile, other.m_hFile);
+        std::swap(m_hMapping, other.m_hMapping);
+#elif !BENCH_HAS_MMAP
+        m_buffer.swap(other.m_buffer);
+#endif
+    }
+
+    const std::byte* data() const   { return m_pData; }
+    size_t size() const             { return m_nSize; }
+
+private:
+    void close()
+    {
+#if defined(_WIN32)
+        if (m_pData)
+            ::UnmapViewOfFile(m_pData);
+        if (m_hMapping)
+            ::CloseHandle(m_hMapping);
+        if (m_hFile != INVALID_HANDLE_VALUE)
+            ::CloseHandle(m_hFile);
+        m_hMapping = nullptr;
+        m_hFile = INVALID_HANDLE_VALUE;
+#elif BENCH_HAS_MMAP
+        if (m_pData)
+            ::munmap(const_cast<std::byte*>(m_pData), m_nSize);
+#else
+        m_buffer.clear();
+#endif
+        m_pData = nullptr;
+        m_nSize = 0;
+    }
+
+    const std::byte* m_pData = nullptr;
+    size_t m_nSize = 0;
+#if defined(_WIN32)
+    HANDLE m_hFile = INVALID_HANDLE_VALUE;
+    HANDLE m_hMapping = nullptr;
+#elif !BENCH_HAS_MMAP
+    std::vector<std::byte> m_buffer;
+#endif
+}; // class MappedFile
+
+// Zero-copy view to records of a trace file.
+class TraceView
+{
+public:
+    explicit TraceView(const std::string& sPath)
+        : m_file(sPath)
+    {
+        TraceFileHeader header;
+        if (m_file.size() < sizeof(header))
+            throw std::runtime_error("'" + sPath + "' is not a trace file: too small");
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        if (std::memcmp(header.m_magic, TraceFileHeader::magic, sizeof(header.m_magic)) != 0)
+            throw std::runtime_error("'" + sPath + "' is not a trace file: invalid magic");
+        if (header.m_nEndianMarker != TraceFileHeader::endianMarker)
+            throw std::runtime_error("'" + sPath + "' has been written with different byte order");
+        if (header.m_nVersion != TraceFileHeader::currentVersion || header.m_nRecordSize != sizeof(TraceRecord))
+            throw std::runtime_error("'" + sPath + "' has unsupported trace format version or record size");
+        if (header.m_nRecordCount > (m_file.size() - sizeof(header)) / sizeof(TraceRecord))
+            throw std::runtime_error("'" + sPath + "' is truncated");
+        m_nCount = static_cast<size_t>(header.m_nRecordCount);
+    }
+
+    const TraceRecord* begin() const    { return reinterpret_cast<const TraceRecord*>(m_file.data() + sizeof(TraceFileHeader)); }
+    const TraceRecord* end() const      { return begin() + m_nCount; }
+    size_t size() const                 { return m_nCount; }
+    bool empty() const                  { return m_nCount == 0; }
+    const TraceRecord& operator[](const size_t i) const { return begin()[i]; }
+
+    size_t countOf(const TraceOp op) const
+    {
+        size_t n = 0;
+        for (const auto& record : *this)
+            n += (record.m_op == op);
+        return n;
+    }
+
+    // Throws std::runtime_error if some record has unknown operation code, e.g. to reject trace before timed replay.
+    void checkOps() const
+    {
+        for (size_t i = 0; i < m_nCount; ++i)
+        {
+            if (!isKnownTraceOp((*this)[i].m_op))
+                detail::throwUnknownTraceOp((*this)[i], i);
+        }
+    }
+
+    // Reads one byte from every page of the records so that the mapping is resident before timed replay. Returns a value
+    // computed from the bytes so that reads are not optimized away.
+    size_t prefault() const
+    {
+        const size_t nPageSize = 4096;
+        const auto pBytes = reinterpret_cast<const unsigned char*>(begin());
+        const auto nByteCount = m_nCount * sizeof(TraceRecord);
+        size_t nSum = 0;
+        for (size_t i = 0; i < nByteCount; i += nPageSize)
+            nSum += pBytes[i];
+        return nSum;
+    }
+
+private:
+    MappedFile m_file;
+    size_t m_nCount = 0;
+}; // class TraceView
+
+// Writes trace file. Valid header is written only by close(), which should be called once all records have been written;
+// until then the file starts with a zero-filled placeholder header. If the writer is destroyed without close() having been
+// called, e.g. due to an exception while producing records, the incomplete file is removed.
+class TraceWriter
+{
+public:
+    explicit TraceWriter(const std::string& sPath)
+        : m_sPath(sPath)
+        , m_ostrm(sPath, std::ios::binary | std::ios::trunc)
+    {
+        if (!m_ostrm)
+            throw std::runtime_error("Unable to open '" + sPath + "' for writing");
+        const TraceFileHeader placeholder{};
+        m_ostrm.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    ~TraceWriter()
+    {
+        if (m_ostrm.is_open())
+            discard();
+    }
+
+    void write(const TraceRecord& record)
+    {
+        m_ostrm.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        ++m_nCount;
+    }
+
+    void write(const TraceOp op, const int64_t nKey, const int64_t nValue = 0, const uint32_t nPosition = 0)
+    {
+        write(TraceRecord{ op, nPosition, nKey, nValue });
+    }
+
+    size_t recordCount() const { return m_nCount; }
+
+    void close()
+    {
+        if (!m_ostrm.is_open())
+            return;
+        m_ostrm.seekp(0);
+        writeHeader();
+        m_ostrm.close();
+        if (m_ostrm.fail())
+        {
+            std::remove(m_sPath.c_str());
+            throw std::runtime_error("Writing to '" + m_sPath + "' failed");
+        }
+    }
+
+private:
+    void discard()
+    {
+        m_ostrm.close();
+        std::remove(m_sPath.c_str());
+    }
+
+    void writeHeader()
+    {
+        TraceFileHeader header{};
+        std::memcpy(header.m_magic, TraceFileHeader::magic, sizeof(header.m_magic));
+        header.m_nVersion = TraceFileHeader::currentVersion;
+        header.m_nRecordSize = sizeof(TraceRecord);
+        header.m_nRecordCount = m_nCount;
+        header.m_nEndianMarker = TraceFileHeader::endianMarker;
+        m_ostrm.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    std::string m_sPath;
+    std::ofstream m_ostrm;
+    uint64_t m_nCount = 0;
+}; // class TraceWriter
+
+// Replays records [pFirst, pLast) to handler, see file comment. Returns the number of finds that returned true. Throws
+// std::runtime_error on record with unknown operation code; records before it have been replayed.
+template <class Handler_T>
+size_t replayTrace(const TraceRecord* const pFirst, const TraceRecord* const pLast, Handler_T& handler)
+{
+    size_t nFound = 0;
+    for (auto p = pFirst; p != pLast; ++p)
+    {
+        const auto& record = *p;
+        switch (record.m_op)
+        {
+            case TraceOp::insert:   handler.onInsert(record.m_nKey, record.m_nValue); break;
+            case TraceOp::find:     nFound += static_cast<bool>(handler.onFind(record.m_nKey)); break;
+            case TraceOp::erase:    handler.onErase(record.m_nKey); break;
+            case TraceOp::insertAt: handler.onInsertAt(record.m_nPosition, record.m_nKey, record.m_nValue); break;
+            case TraceOp::update:   handler.onUpdate(record.m_nKey, record.m_nValue); break;
+            default:                detail::throwUnknownTraceOp(record, static_cast<size_t>(p - pFirst));
+        }
+    }
+    return nFound;
+}
+
+template <class Handler_T>
+size_t replayTrace(const TraceView& trace, Handler_T& handler)
+{
+    return replayTrace(trace.begin(), trace.end(), handler);
+}
+
+} // namespace bench
@@ -50,20 +50,117 @@ Notes:
     -The larger the lookup string length is, the worse the effect of the classic temporary std::string gets.
     -heterogeneous lookup suffers a huge performance penalty with increasing lookup string size
         -This is caused by strlen() getting called on every operator<(std::string, const char*) for the lookup string.
+    -"prefix-cached const char* lookup" uses PrefixCachedString keys that store the first 8 bytes of the string as a big-endian
+     integer next to the string: most comparisons are decided by one integer comparison without reading the string buffer,
+     and const char* lookup string is converted to PrefixCachedStringView (one strlen()) once per find().
+    -Lookup strings come from common/keyStream.hpp and are generated before timing. Hits are drawn from up to 1000 keys of
+     lookup string length that are added to the map (number followed by '_' padding, e.g. "12__"), so there are hits with every
+     lookup length; misses are strings of the same form that end with '#'. Hit ratio, Zipf exponent and working set size can
+     be set with --hit-ratio=<0..1>, --zipf=<exponent> and --working-set=<N>, default is uniform hits only.
+       -The example run above predates this: it looked up 3 strings of repeated digits, which never hit at lengths 32 and above.
+    -With --trace=<path>, lookups are the find records of a binary operation trace (common/traceFile.hpp) instead of generated
+     stream: key k is looked up as k padded with '_' to lookup string length (or plain k if it's longer), so whether it hits
+     depends on the map content like above. Other record types are ignored. Lookup strings are created before timing.
+    -"3 static keys" runs use a map with keys "0", "1" and "2" known at compile time, comparing std::map, std::unordered_map and
+     a sorted vector of pairs (MapVector-like baseline; this program doesn't use dfglib) to bench::StaticPerfectHashMap
+     (common/StaticPerfectHashMap.hpp) that does one hash, one probe and one comparison per find(). Lookups are the static
+     keys and equally many misses of lookup string length (key padded with '_' and ending with '#'); the number of hits is
+     checked after every run.
 
 */
 
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <chrono>
 #include <random>
 #include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/commandLine.hpp"
+#include "../common/keyStream.hpp"
+#include "../common/StaticPerfectHashMap.hpp"
+#include "../common/traceFile.hpp"
+
+// First up to 8 bytes of string as big-endian integer padded with zeros, so that comparing prefixes of two strings as
+// integers gives the same order as comparing the first 8 bytes lexicographically as unsigned chars (like std::string does).
+inline uint64_t stringPrefix(const std::string_view sv)
+{
+    uint64_t nPrefix = 0;
+    for (size_t i = 0; i < sizeof(nPrefix); ++i)
+        nPrefix = (nPrefix << 8) | ((i < sv.size()) ? static_cast<unsigned char>(sv[i]) : 0u);
+    return nPrefix;
+}
+
+// Non-owning lookup key for maps with PrefixCachedLess.
+struct PrefixCachedStringView
+{
+    PrefixCachedStringView(const char* psz) : PrefixCachedStringView(std::string_view(psz)) {}
+    PrefixCachedStringView(const std::string_view sv) : m_nPrefix(stringPrefix(sv)), m_sv(sv) {}
+
+    uint64_t m_nPrefix;
+    std::string_view m_sv;
+};
+
+// String with cached prefix: holds length and pointer (in std::string) and the prefix inline.
+class PrefixCachedString
+{
+public:
+    PrefixCachedString(std::string s) : m_nPrefix(stringPrefix(s)), m_s(std::move(s)) {}
+
+    uint64_t prefix() const         { return m_nPrefix; }
+    std::string_view view() const   { return m_s; }
+
+private:
+    uint64_t m_nPrefix;
+    std::string m_s;
+};
+
+// Transparent comparator for PrefixCachedString and PrefixCachedStringView: full string comparison is needed only when
+// prefixes are equal, i.e. when strings share the first 8 bytes or one is a padded prefix of the other.
+struct PrefixCachedLess
+{
+    using is_transparent = void;
+
+    template <class T0, class T1>
+    bool operator()(const T0& left, const T1& right) const
+    {
+        const auto nLeftPrefix = prefixOf(left);
+        const auto nRightPrefix = prefixOf(right);
+        if (nLeftPrefix != nRightPrefix)
+            return nLeftPrefix < nRightPrefix;
+        return viewOf(left) < viewOf(right);
+    }
+
+    static uint64_t prefixOf(const PrefixCachedString& s)           { return s.prefix(); }
+    static uint64_t prefixOf(const PrefixCachedStringView& s)       { return s.m_nPrefix; }
+    static std::string_view viewOf(const PrefixCachedString& s)     { return s.view(); }
+    static std::string_view viewOf(const PrefixCachedStringView& s) { return s.m_sv; }
+};
 
 const char*         lookupTypeConstCharPtr(const std::string& s) { return s.c_str(); }
 const std::string&  lookupTypeStdString(const std::string& s)    { return s; }
 std::string_view    lookupTypeStringView(const std::string& s)   { return std::string_view(s); }
+PrefixCachedStringView lookupTypePrefixCached(const std::string& s) { return PrefixCachedStringView(s.c_str()); }
+
+bench::KeyStreamParams keyStreamParams;
+const bench::TraceView* pLookupTrace = nullptr; // If not null, lookups are the find records of this trace.
+bool bUnexpectedHitCount = false; // Set if a static key set run finds other number of keys than it looks up.
+
+// Returns number padded with '_' to nLength, empty if number doesn't fit.
+std::string paddedNumberKey(const size_t n, const size_t nLength)
+{
+    auto s = std::to_string(n);
+    if (s.size() > nLength)
+        return std::string();
+    s.resize(nLength, '_');
+    return s;
+}
 
 template <class Cont_T, class Func_T>
 void runImpl(const size_t nLookupStringLength, Func_T toLookupType)
@@ -73,28 +170,61 @@ void runImpl(const size_t nLookupStringLength, Func_T toLookupType)
 
     const size_t nMapSize = 100000;
     const size_t nIterCount = 1000000;
-
-    std::array<std::string, 3> arrLookupStrings =
-    {
-        std::string(nLookupStringLength, '0'),
-        std::string(nLookupStringLength, '1'),
-        std::string(nLookupStringLength, '2')
-    };
+    const size_t nMaxLookupLengthKeyCount = 1000;
 
     Cont_T cont;
     for (size_t i = 0; i < nMapSize; ++i)
         cont.insert(std::pair<std::string, unsigned int>(std::to_string(i), randEng()));
 
-    std::uniform_int_distribution<size_t> lookupDistr(0, arrLookupStrings.size() - 1);
+    // Keys with lookup string length that hits are drawn from and misses of the same form.
+    std::vector<std::string> hitKeys;
+    std::vector<std::string> missKeys;
+    for (size_t i = 0; i < nMaxLookupLengthKeyCount; ++i)
+    {
+        auto s = paddedNumberKey(i, nLookupStringLength);
+        if (s.empty())
+            break;
+        cont.insert(std::pair<std::string, unsigned int>(s, randEng())); // Doesn't insert if number without padding is already in map.
+        hitKeys.push_back(s);
+        s.back() = '#';
+        missKeys.push_back(std::move(s));
+    }
+
+    std::vector<const std::string*> lookupStrings;
+    std::unordered_map<int64_t, std::string> traceKeyStrings; // One string per distinct trace key.
+    if (pLookupTrace)
+    {
+        lookupStrings.reserve(pLookupTrace->countOf(bench::TraceOp::find));
+        for (const auto& record : *pLookupTrace)
+        {
+            if (record.m_op != bench::TraceOp::find)
+                continue;
+            auto iter = traceKeyStrings.find(record.m_nKey);
+            if (iter == traceKeyStrings.end())
+            {
+                auto sKey = (record.m_nKey >= 0) ? paddedNumberKey(static_cast<size_t>(record.m_nKey), nLookupStringLength) : std::string();
+                if (sKey.empty())
+                    sKey = std::to_string(record.m_nKey);
+                iter = traceKeyStrings.emplace(record.m_nKey, std::move(sKey)).first;
+            }
+            lookupStrings.push_back(&iter->second);
+        }
+    }
+    else
+    {
+        std::uniform_int_distribution<size_t> missDistr(0, missKeys.size() - 1);
+        lookupStrings = bench::generateKeyStream<const std::string*>(hitKeys.size(), nIterCount, keyStreamParams, randEng,
+                                                                     [&](const size_t i) { return &hitKeys[i]; },
+                                                                     [&](std::mt19937& re) { return &missKeys[missDistr(re)]; });
+    }
 
     const auto endIter = cont.end();
     size_t nSum = 0;
     std::chrono::high_resolution_clock timer;
     const auto startTime = timer.now();
-    for (size_t i = 0; i < nIterCount; ++i)
+    for (const auto pLookupString : lookupStrings)
     {
-        const auto index = lookupDistr(randEng);
-        auto iter = cont.find(toLookupType(arrLookupStrings[index]));
+        auto iter = cont.find(toLookupType(*pLookupString));
         if (iter != endIter)
             nSum += iter->second;
     }
@@ -102,6 +232,103 @@ void runImpl(const size_t nLookupStringLength, Func_T toLookupType)
     std::cout << "length " << nLookupStringLength << ", time: " << std::chrono::duration<double>(endTime - startTime).count() << ", sum: " << nSum << "\n";
 }
 
+constexpr std::pair<std::string_view, unsigned int> staticKeyItems[] = { { "0", 1000 }, { "1", 1001 }, { "2", 1002 } };
+constexpr auto staticPerfectHashMap = bench::makeStaticPerfectHashMap(staticKeyItems);
+
+// Like runImpl(), but with map of staticKeyItems; findValue(lookupString) returns pointer to value or nullptr. Lookup strings
+// are the static keys (hits) and misses of nLookupStringLength.
+template <class FindFunc_T>
+void runStaticKeySetImpl(const size_t nLookupStringLength, FindFunc_T findValue)
+{
+    std::mt19937 randEng;
+    randEng.seed(123456);
+
+    const size_t nIterCount = 1000000;
+    const size_t nStaticKeyCount = std::size(staticKeyItems);
+
+    // Indexes [0, nStaticKeyCount) are hits, the rest misses.
+    std::array<std::string, 2 * nStaticKeyCount> arrLookupStrings;
+    for (size_t i = 0; i < nStaticKeyCount; ++i)
+    {
+        arrLookupStrings[i] = staticKeyItems[i].first;
+        auto sMiss = arrLookupStrings[i];
+        sMiss.resize(nLookupStringLength, '_');
+        sMiss.back() = '#';
+        arrLookupStrings[nStaticKeyCount + i] = std::move(sMiss);
+    }
+
+    std::uniform_int_distribution<size_t> lookupDistr(0, arrLookupStrings.size() - 1);
+    std::vector<size_t> lookupIndexes(nIterCount);
+    size_t nExpectedHitCount = 0;
+    for (auto& index : lookupIndexes)
+    {
+        index = lookupDistr(randEng);
+        nExpectedHitCount += (index < nStaticKeyCount);
+    }
+
+    size_t nSum = 0;
+    size_t nHitCount = 0;
+    std::chrono::high_resolution_clock timer;
+    const auto startTime = timer.now();
+    for (const auto index : lookupIndexes)
+    {
+        const auto pValue = findValue(arrLookupStrings[index]);
+        if (pValue)
+        {
+            nSum += *pValue;
+            ++nHitCount;
+        }
+    }
+    const auto endTime = timer.now();
+    std::cout << "length " << nLookupStringLength << ", time: " << std::chrono::duration<double>(endTime - startTime).count() << ", sum: " << nSum << ", hits: " << nHitCount << "\n";
+    if (nHitCount != nExpectedHitCount)
+    {
+        std::cerr << "Error: expected " << nExpectedHitCount << " hits, got " << nHitCount << '\n';
+        bUnexpectedHitCount = true;
+    }
+}
+
+void doStaticKeySetRuns(const size_t nLookupStringLength)
+{
+    std::map<std::string, unsigned int, std::less<>> stdMap;
+    std::unordered_map<std::string, unsigned int> stdUnorderedMap;
+    std::vector<std::pair<std::string, unsigned int>> sortedVector;
+    for (const auto& item : staticKeyItems)
+    {
+        stdMap.insert(std::pair<std::string, unsigned int>(item.first, item.second));
+        stdUnorderedMap.insert(std::pair<std::string, unsigned int>(item.first, item.second));
+        sortedVector.push_back(std::pair<std::string, unsigned int>(item.first, item.second));
+    }
+    std::sort(sortedVector.begin(), sortedVector.end());
+
+    std::cout << "3 static keys, std::less<> string_view lookup ";
+    runStaticKeySetImpl(nLookupStringLength, [&](const std::string& s) -> const unsigned int*
+    {
+        const auto iter = stdMap.find(std::string_view(s));
+        return (iter != stdMap.end()) ? &iter->second : nullptr;
+    });
+    std::cout << "3 static keys, unordered_map std::string lookup ";
+    runStaticKeySetImpl(nLookupStringLength, [&](const std::string& s) -> const unsigned int*
+    {
+        const auto iter = stdUnorderedMap.find(s);
+        return (iter != stdUnorderedMap.end()) ? &iter->second : nullptr;
+    });
+    std::cout << "3 static keys, sorted vector string_view lookup ";
+    runStaticKeySetImpl(nLookupStringLength, [&](const std::string& s) -> const unsigned int*
+    {
+        const std::string_view sv(s);
+        const auto iter = std::lower_bound(sortedVector.begin(), sortedVector.end(), sv, [](const std::pair<std::string, unsigned int>& item, const std::string_view& key)
+        {
+            return std::string_view(item.first) < key;
+        });
+        return (iter != sortedVector.end() && iter->first == sv) ? &iter->second : nullptr;
+    });
+    std::cout << "3 static keys, perfect hash const char* lookup ";
+    runStaticKeySetImpl(nLookupStringLength, [&](const std::string& s) { return staticPerfectHashMap.find(s.c_str()); });
+    std::cout << "3 static keys, perfect hash string_view lookup ";
+    runStaticKeySetImpl(nLookupStringLength, [&](const std::string& s) { return staticPerfectHashMap.find(std::string_view(s)); });
+}
+
 void doRuns(const size_t nLookupStringLength)
 {
     std::cout << "Runs with lookup length " << nLookupStringLength << '\n';
@@ -114,10 +341,42 @@ void doRuns(const size_t nLookupStringLength)
     runImpl<std::map<std::string, unsigned int, std::less<>>>(nLookupStringLength, lookupTypeConstCharPtr);
     std::cout << "string_view lookup ";
     runImpl<std::map<std::string, unsigned int, std::less<>>>(nLookupStringLength, lookupTypeStringView);
+    std::cout << "prefix-cached const char* lookup ";
+    runImpl<std::map<PrefixCachedString, unsigned int, PrefixCachedLess>>(nLookupStringLength, lookupTypePrefixCached);
+    doStaticKeySetRuns(nLookupStringLength);
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    std::string sTracePath;
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = bench::splitCommandLineArg(argv[i]);
+        if (arg.name == "--trace" && !arg.value.empty())
+            sTracePath = arg.value;
+        else if (!bench::applyKeyStreamOption(keyStreamParams, arg.name, arg.value))
+        {
+            std::cerr << "Invalid argument '" << argv[i] << "', expected --hit-ratio=<0..1>, --zipf=<exponent>, --working-set=<N> or --trace=<path>\n";
+            return 1;
+        }
+    }
+    std::unique_ptr<bench::TraceView> spTrace;
+    if (!sTracePath.empty())
+    {
+        try
+        {
+            spTrace = std::make_unique<bench::TraceView>(sTracePath);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Unable to use trace: " << e.what() << '\n';
+            return 1;
+        }
+        pLookupTrace = spTrace.get();
+        std::cout << "Lookups: find records of " << sTracePath << " (" << spTrace->countOf(bench::TraceOp::find) << ")\n\n";
+    }
+    else
+        std::cout << "Key stream: " << bench::keyStreamParamsDescription(keyStreamParams) << "\n\n";
     doRuns(1);
     std::cout << '\n';
     doRuns(3);
@@ -127,4 +386,5 @@ int main()
     doRuns(1000);
     std::cout << '\n';
     doRuns(5000);
+    return (bUnexpectedHitCount) ? 1 : 0;
 }
@@ -27,12 +27,32 @@ DFG_ROOT_NS_BEGIN{ DFG_SUB_NS(TypeTraits)
 #include <dfg/rand.hpp>
 #include <dfg/str/format_fmt.hpp>
 #include <dfg/time/timerCpu.hpp>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
 #include <map>
+#include <optional>
 #include <type_traits>
 #include <unordered_map>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/vector.hpp>
 
+#include "../common/batchInsert.hpp"
+#include "../common/FlatHashMap.hpp"
+#include "../common/heapUsage.hpp"
+#include "../common/interleavedLookup.hpp"
+#include "../common/keyStream.hpp"
+#include "../common/latencyHistogram.hpp"
+#include "../common/memoryResources.hpp"
+#include "../common/parallelSortUnique.hpp"
+#include "../common/perfCounters.hpp"
+#include "../common/repetitionRunner.hpp"
+#include "../common/searchPolicies.hpp"
+#include "../common/StaticPerfectHashMap.hpp"
+#include "../common/StringPoolFlatMap.hpp"
+#include "../common/TombstoneFlatMap.hpp"
+#include "../common/traceFile.hpp"
+
 #include <dfg/time.hpp>
 #include <dfg/time/DateTime.hpp>
 
@@ -59,6 +79,23 @@ std::string containerDescription(const std::unordered_map<Key_T, Val_T>&) { retu
 
 template <class Key_T, class Val_T>
 std::string containerDescription(const boost::container::flat_map<Key_T, Val_T>&) { return "boost::flat_map<" + typeToName<Key_T>::name() + "," + typeToName<Val_T>::name() + ">"; }
+
+template <class Key_T, class Val_T>
+std::string containerDescription(const bench::FlatHashMap<Key_T, Val_T>&) { return "bench::FlatHashMap<" + typeToName<Key_T>::name() + "," + typeToName<Val_T>::name() + ">"; }
+
+#if BENCH_HAS_PMR
+template <class Key_T, class Val_T>
+std::string containerDescription(const std::pmr::map<Key_T, Val_T>& cont)
+{
+    return DFG_ROOT_NS::format_fmt("std::pmr::map<{},{}> ({})", typeToName<Key_T>::name(), typeToName<Val_T>::name(), bench::memoryResourceDescription(cont.get_allocator().resource()));
+}
+template <class Key_T, class Val_T>
+std::string containerDescription(const std::pmr::unordered_map<Key_T, Val_T>& cont)
+{
+    return DFG_ROOT_NS::format_fmt("std::pmr::unordered_map<{},{}> ({})", typeToName<Key_T>::name(), typeToName<Val_T>::name(), bench::memoryResourceDescription(cont.get_allocator().resource()));
+}
+#endif // BENCH_HAS_PMR
+
 template <class Key_T, class Val_T>
 std::string containerDescription(const DFG_MODULE_NS(cont)::MapVectorAoS<Key_T, Val_T>& cont)
 {
@@ -70,6 +107,34 @@ std::string containerDescription(const DFG_MODULE_NS(cont)::MapVectorSoA<Key_T,
     return DFG_ROOT_NS::format_fmt("MapVectorSoA<{},{}>, sorted: {}", typeToName<Key_T>::name(), typeToName<Val_T>::name(), int(cont.isSorted()));
 }
 
+// Find-only view to MapVectorSoA that searches the contiguous key storage with given policy from common/searchPolicies.hpp
+// instead of MapVectorSoA::find(). find() returns key index, end() the size.
+template <class Key_T, class Val_T, class SearchPolicy_T>
+class SearchPolicyMapVectorSoAView
+{
+public:
+    SearchPolicyMapVectorSoAView(const DFG_MODULE_NS(cont)::MapVectorSoA<Key_T, Val_T>& m)
+        : m_rMap(m)
+    {}
+
+    size_t find(const Key_T& key) const
+    {
+        const auto keys = m_rMap.keyRange();
+        return SearchPolicy_T::find(std::to_address(keys.begin()), m_rMap.size(), key);
+    }
+
+    size_t end() const  { return m_rMap.size(); }
+    size_t size() const { return m_rMap.size(); }
+
+    const DFG_MODULE_NS(cont)::MapVectorSoA<Key_T, Val_T>& m_rMap;
+};
+
+template <class Key_T, class Val_T, class SearchPolicy_T>
+std::string containerDescription(const SearchPolicyMapVectorSoAView<Key_T, Val_T, SearchPolicy_T>& view)
+{
+    return containerDescription(view.m_rMap) + DFG_ROOT_NS::format_fmt(", find: {}", SearchPolicy_T::name());
+}
+
 template <class Val_T>
 std::string containerDescription(const DFG_MODULE_NS(cont)::Vector<Val_T>&)
 {
@@ -91,6 +156,41 @@ namespace
         typedef DFG_ROOT_NS::uint32 uint32;
 
     public:
+        // Index of the first test specific column in tables created with column list.
+        static constexpr uint32 firstTestColumn = 5;
+
+        BenchmarkResultTable() = default;
+
+        // Adds the common columns Date, Test machine, Test Compiler, Pointer size and Build type followed by testColumns and
+        // requested hardware counter columns, and fills the common columns of rows [1, nRowCount]. Results start from
+        // column lastStaticColumn() + 1.
+        BenchmarkResultTable(std::initializer_list<const char*> testColumns, const size_t nRowCount)
+        {
+            using namespace DFG_ROOT_NS;
+            using namespace DFG_MODULE_NS(str);
+            const char* const commonColumns[] = { "Date", "Test machine", "Test Compiler", "Pointer size", "Build type" };
+            uint32 nCol = 0;
+            for (const auto psz : commonColumns)
+                this->addString(SzPtrUtf8(psz), 0, nCol++);
+            for (const auto psz : testColumns)
+                this->addString(SzPtrUtf8(psz), 0, nCol++);
+            m_nLastStaticColumn = nCol - 1 + addPerfCounterColumns(nCol);
+
+            const StringUtf8 sTime(SzPtrUtf8(DFG_MODULE_NS(time)::localDate_yyyy_mm_dd_C().c_str()));
+            const auto sCompiler = SzPtrUtf8(DFG_COMPILER_NAME_SIMPLE);
+            const StringUtf8 sPointerSize(SzPtrUtf8(toStrC(sizeof(void*)).c_str()));
+            const auto sBuildType = SzPtrUtf8(DFG_BUILD_DEBUG_RELEASE_TYPE);
+            for (uint32 r = 1; r <= nRowCount; ++r)
+            {
+                this->addString(sTime, r, 0);
+                this->addString(sCompiler, r, 2);
+                this->addString(sPointerSize, r, 3);
+                this->addString(sBuildType, r, 4);
+            }
+        }
+
+        uint32 lastStaticColumn() const { return m_nLastStaticColumn; }
+
         void addReducedValuesAndWriteToFile(const size_t nFirstResultColumn, const dfg::StringViewSzAscii& svBaseName)
         {
             // Calculate averages etc.
@@ -111,29 +211,191 @@ namespace
             this->addString(DFG_ASCII("avg"),       0, nColCount);
             this->addString(DFG_ASCII("median"),    0, nColCount + 1);
             this->addString(DFG_ASCII("sum"),       0, nColCount + 2);
+            this->addString(DFG_ASCII("min"),       0, nColCount + 3);
+            this->addString(DFG_ASCII("MAD"),       0, nColCount + 4);
+            this->addString(DFG_ASCII("median CI95 low"),   0, nColCount + 5);
+            this->addString(DFG_ASCII("median CI95 high"),  0, nColCount + 6);
+            this->addString(DFG_ASCII("sample count"),      0, nColCount + 7);
             
             DFG_MODULE_NS(cont)::ValueVector<double> vals;
             for (uint32 r = 1; r < nRowCount; ++r)
             {
-                vals.clear();
-                for (uint32 c = firstResultCol; c < nColCount; ++c)
-                {
-                    auto p = (*this)(r, c);
-                    if (!p)
-                        continue;
-                    vals.push_back(DFG_MODULE_NS(str)::strTo<double>(p.rawPtr()));
-                }
+                measuredValues(r, firstResultCol, nColCount, vals);
+                if (vals.empty())
+                    continue;
 
                 const auto avg = vals.average();
                 const auto median = vals.median();
                 const auto sum = vals.sum();
+                const auto summary = bench::summarizeSamples(std::vector<double>(vals.begin(), vals.end()));
 
                 char sz[32];
                 this->addString(SzPtrUtf8(toStr(avg, sz, 6)), r, nColCount);
                 this->addString(SzPtrUtf8(toStr(median, sz, 6)), r, nColCount + 1);
                 this->addString(SzPtrUtf8(toStr(sum, sz, 6)), r, nColCount + 2);
+                this->addString(SzPtrUtf8(toStr(summary.min, sz, 6)), r, nColCount + 3);
+                this->addString(SzPtrUtf8(toStr(summary.mad, sz, 6)), r, nColCount + 4);
+                this->addString(SzPtrUtf8(toStr(summary.ciLow, sz, 6)), r, nColCount + 5);
+                this->addString(SzPtrUtf8(toStr(summary.ciHigh, sz, 6)), r, nColCount + 6);
+                this->addString(SzPtrUtf8(toStrC(summary.nCount).c_str()), r, nColCount + 7);
+            }
+        }
+
+        // Sets column of given iteration label (e.g. "Time#0" from RepetitionController::iterationLabel()) as the column
+        // where testers write results, adding the column if there's none yet. Tests that loop iterations inside an outer
+        // loop, e.g. key counts, share the columns between outer loop rounds.
+        void beginIteration(const std::string& sLabel)
+        {
+            using namespace DFG_ROOT_NS;
+            const auto nColCount = this->colCountByMaxColIndex();
+            for (uint32 c = 0; c < nColCount; ++c)
+            {
+                auto p = (*this)(0, c);
+                if (!p)
+                    continue;
+                if (sLabel == p.rawPtr())
+                {
+                    m_nResultColumn = c;
+                    return;
+                }
+            }
+            this->addString(SzPtrUtf8(sLabel.c_str()), 0, nColCount);
+            m_nResultColumn = nColCount;
+        }
+
+        uint32 resultColumn() const { return m_nResultColumn; }
+
+        // Returns the largest bench::SampleSummary::relativeCiHalfWidth() of measured values on rows [nFirstRow, nEndRow).
+        double maxRelativeCiHalfWidth(const uint32 firstResultCol, const uint32 nFirstRow = 1, const uint32 nEndRow = DFG_ROOT_NS::NumericTraits<uint32>::maxValue)
+        {
+            const auto nRowEnd = (std::min)(nEndRow, static_cast<uint32>(this->rowCountByMaxRowIndex()));
+            const auto nColCount = this->colCountByMaxColIndex();
+            DFG_MODULE_NS(cont)::ValueVector<double> vals;
+            double maxCi = 0;
+            for (uint32 r = nFirstRow; r < nRowEnd; ++r)
+            {
+                measuredValues(r, firstResultCol, nColCount, vals);
+                maxCi = (std::max)(maxCi, bench::summarizeSamples(std::vector<double>(vals.begin(), vals.end())).relativeCiHalfWidth());
+            }
+            return maxCi;
+        }
+
+        // If hardware counter capture is requested with environment variable BENCHMARK_PERF_COUNTERS=1, adds per operation
+        // counter columns starting from nFirstColumn. Returns the number of columns added.
+        uint32 addPerfCounterColumns(const uint32 nFirstColumn)
+        {
+            using namespace DFG_ROOT_NS;
+            if (!bench::perfCountersRequestedByEnvironment())
+                return 0;
+            if (!bench::PerfCounters().anyAvailable())
+                std::cout << "Note: hardware performance counters are not available, counter columns will be empty\n";
+            m_nFirstPerfCounterColumn = nFirstColumn;
+            for (uint32 i = 0; i < bench::perfCounterCount; ++i)
+                this->addString(SzPtrUtf8(bench::perfCounterColumnName(static_cast<bench::PerfCounterId>(i))), 0, nFirstColumn + i);
+            return static_cast<uint32>(bench::perfCounterCount);
+        }
+
+        bool hasPerfCounterColumns() const { return m_nFirstPerfCounterColumn != DFG_ROOT_NS::NumericTraits<uint32>::maxValue; }
+
+        // Sets counter values normalized by nOpCount to given row; values of the latest iteration are kept.
+        void setPerfCounterValues(const uint32 nRow, const bench::PerfCounterValues& values, const double nOpCount)
+        {
+            using namespace DFG_ROOT_NS;
+            using namespace DFG_MODULE_NS(str);
+            if (!hasPerfCounterColumns())
+                return;
+            for (uint32 i = 0; i < bench::perfCounterCount; ++i)
+            {
+                const auto id = static_cast<bench::PerfCounterId>(i);
+                if (!values.isAvailable(id))
+                    continue;
+                char sz[32];
+                this->setElement(nRow, m_nFirstPerfCounterColumn + i, SzPtrUtf8(toStr(values.perOperation(id, nOpCount), sz, 6)));
+            }
+        }
+
+    private:
+        // Stores values of row r in result columns [firstResultCol, nColEnd) to vals skipping warmup columns.
+        void measuredValues(const uint32 r, const uint32 firstResultCol, const uint32 nColEnd, DFG_MODULE_NS(cont)::ValueVector<double>& vals)
+        {
+            vals.clear();
+            for (uint32 c = firstResultCol; c < nColEnd; ++c)
+            {
+                auto pHeader = (*this)(0, c);
+                if (!pHeader || std::strncmp(pHeader.rawPtr(), "Warmup#", 7) == 0)
+                    continue;
+                auto p = (*this)(r, c);
+                if (!p)
+                    continue;
+                vals.push_back(DFG_MODULE_NS(str)::strTo<double>(p.rawPtr()));
+            }
+        }
+
+        uint32 m_nFirstPerfCounterColumn = DFG_ROOT_NS::NumericTraits<uint32>::maxValue;
+        uint32 m_nResultColumn = 0;
+        uint32 m_nLastStaticColumn = 0;
+    };
+
+    // Timed region of one result row in a table created with column list: hardware counters and timer start on construction.
+    // Typical tester:
+    //     TimedRow timedRow(resultTable, nRow);
+    //     <timed region>
+    //     const auto elapsed = timedRow.stop(nOpCount);
+    //     timedRow.record({ <test column values> }, { <columns to check> }, <result>);
+    class TimedRow
+    {
+        typedef DFG_ROOT_NS::uint32 uint32;
+
+    public:
+        TimedRow(BenchmarkResultTable& resultTable, const size_t nRow)
+            : m_resultTable(resultTable)
+            , m_nRow(static_cast<uint32>(nRow))
+            , m_perfCounters(resultTable.hasPerfCounterColumns())
+        {
+            m_perfCounters.start();
+            m_timer.emplace();
+        }
+
+        // Ends timed region and sets counter values normalized by opCount to the row. Returns elapsed wall time in seconds.
+        double stop(const double opCount)
+        {
+            const auto elapsed = m_timer->elapsedWallSeconds();
+            m_resultTable.setPerfCounterValues(m_nRow, m_perfCounters.stop(), opCount);
+            return elapsed;
+        }
+
+        // On the first iteration sets testColumnValues to the test columns of the row, leaving empty values unset; on later
+        // iterations expects values of checkedColumns to be unchanged. Then adds result to the result column of the iteration.
+        void record(std::initializer_list<std::string> testColumnValues, std::initializer_list<uint32> checkedColumns, const double result)
+        {
+            using namespace DFG_ROOT_NS;
+            using namespace DFG_MODULE_NS(str);
+            if (m_resultTable(m_nRow, BenchmarkResultTable::firstTestColumn) == nullptr)
+            {
+                auto nCol = BenchmarkResultTable::firstTestColumn;
+                for (const auto& sValue : testColumnValues)
+                {
+                    if (!sValue.empty())
+                        m_resultTable.setElement(m_nRow, nCol, SzPtrUtf8(sValue.c_str()));
+                    ++nCol;
+                }
+            }
+            else
+            {
+                for (const auto nCol : checkedColumns)
+                {
+                    const auto p = m_resultTable(m_nRow, nCol);
+                    EXPECT_EQ(testColumnValues.begin()[nCol - BenchmarkResultTable::firstTestColumn], std::string((!p) ? "" : p.rawPtr()));
+                }
             }
+            m_resultTable.addString(floatingPointToStr<StringUtf8>(result, 4 /*number of significant digits*/), m_nRow, m_resultTable.resultColumn());
         }
+
+    private:
+        BenchmarkResultTable& m_resultTable;
+        uint32 m_nRow;
+        bench::PerfCounters m_perfCounters;
+        std::optional<DFG_MODULE_NS(time)::TimerCpu> m_timer;
     };
 
     template <class T>
@@ -158,6 +420,8 @@ Cont_T VectorInsertImpl(Generator_T generator, InsertPosGenerator_T indexGenerat
     using namespace DFG_MODULE_NS(str);
 
     Cont_T cont;
+    bench::PerfCounters perfCounters(pTable && pTable->hasPerfCounterColumns());
+    perfCounters.start();
     DFG_MODULE_NS(time)::TimerCpu timer;
     cont.reserve(nCount);
     cont.push_back(generator(1));
@@ -167,9 +431,12 @@ Cont_T VectorInsertImpl(Generator_T generator, InsertPosGenerator_T indexGenerat
         cont.insert(cont.begin() + nPos, generator(nPos));
     }
     const auto elapsedTime = timer.elapsedWallSeconds();
+    const auto perfCounterValues = perfCounters.stop();
+    if (pTable)
+        pTable->setPerfCounterValues(nRow, perfCounterValues, nCount);
     //const auto sReservationInfo = (capacity != NumericTraits<size_t>::maxValue) ? format_fmt(", reserved: {}", int(capacity >= cont.size())) : "";
     if (pTable)
-        pTable->addString(floatingPointToStr<StringUtf8>(elapsedTime, 4 /*number of significant digits*/), nRow, pTable->colCountByMaxColIndex() - 1);
+        pTable->addString(floatingPointToStr<StringUtf8>(elapsedTime, 4 /*number of significant digits*/), nRow, pTable->resultColumn());
 
     if (nCount > 100)
         std::cout << "Insert time " << containerDescription(cont) /*<< sReservationInfo*/ << ": " << elapsedTime << '\n';
@@ -302,7 +569,7 @@ namespace
             EXPECT_EQ(strTo<size_t>(resultTable(nRow, 6).c_str()), cont.size());
         if (resultTable(nRow, 7) == nullptr)
             resultTable.setElement(nRow, 7, SzPtrUtf8((svDesc.c_str().c_str() + containerDescription(cont) + sReservationInfo).c_str()));
-        resultTable.addString(floatingPointToStr<StringUtf8>(elapsedTime, 4 /*number of significant digits*/), nRow, resultTable.colCountByMaxColIndex() - 1);
+        resultTable.addString(floatingPointToStr<StringUtf8>(elapsedTime, 4 /*number of significant digits*/), nRow, resultTable.resultColumn());
     }
 
     template <class Cont_T>
@@ -313,6 +580,8 @@ namespace
         auto distr = DFG_MODULE_NS(rand)::makeDistributionEngineUniform(&randEng, 0, NumericTraits<int>::maxValue);
         const auto nInitialCapacity = cont.capacity();
         randEng.seed(nRandEngSeed);
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
         DFG_MODULE_NS(time)::TimerCpu timer;
         for (int i = 0; i < nCount; ++i)
         {
@@ -321,26 +590,71 @@ namespace
             cont.push_back(key);
         }
         const auto elapsedTime = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), nCount);
         const auto sReservationInfo = format_fmt("), reserved: {}", int(nInitialCapacity >= cont.size()));
         std::cout << "Insert time with interleaved vector (" << containerDescription(cont) << sReservationInfo << ": " << elapsedTime << '\n';
         AddInsertPerformanceTimeElement(resultTable, elapsedTime, cont, sReservationInfo, nRow, DFG_ASCII("Interleaved "));
     }
 
+    // With environment variable BENCHMARK_LATENCY_SAMPLE=<k>, every k-th insert is timed and latency percentiles are printed
+    // (see common/latencyHistogram.hpp); findPerformanceTester() does the same for finds.
     template <class Cont_T>
     void insertPerformanceTester(Cont_T& cont, const unsigned long nRandEngSeed, const int nCount, const size_t nRow, BenchmarkResultTable& resultTable, const size_t capacity = DFG_ROOT_NS::NumericTraits<size_t>::maxValue)
     {
         using namespace DFG_ROOT_NS;
         auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
         randEng.seed(nRandEngSeed);
+        bench::LatencySampler latencySampler(bench::latencySampleIntervalFromEnvironment());
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
         DFG_MODULE_NS(time)::TimerCpu timer;
-        for (int i = 0; i < nCount; ++i)
-            insertImpl(cont, randEng);
+        if (latencySampler.enabled())
+        {
+            for (int i = 0; i < nCount; ++i)
+                latencySampler.measure([&] { insertImpl(cont, randEng); });
+        }
+        else
+        {
+            for (int i = 0; i < nCount; ++i)
+                insertImpl(cont, randEng);
+        }
         const auto elapsedTime = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), nCount);
         const auto sReservationInfo = (capacity != NumericTraits<size_t>::maxValue) ? format_fmt(", reserved: {}", int(capacity >= cont.size())) : "";
         std::cout << "Insert time " << containerDescription(cont) << sReservationInfo << ": " << elapsedTime << '\n';
+        if (latencySampler.enabled())
+            std::cout << "Insert latency " << containerDescription(cont) << sReservationInfo << ": " << bench::latencyPercentilesDescription(latencySampler.percentiles()) << '\n';
         AddInsertPerformanceTimeElement(resultTable, elapsedTime, cont, sReservationInfo, nRow, DFG_ASCII(""));
     }
 
+#if BENCH_HAS_PMR
+    // Times destruction of the container in holder together with its memory resource. With AllocatorKind::arena this is
+    // the bulk release of the arena instead of per-element destruction (see bench::ResourceBackedContainer).
+    template <class Cont_T>
+    void teardownPerformanceTester(std::optional<bench::ResourceBackedContainer<Cont_T>>& holder, const size_t nRow, BenchmarkResultTable& resultTable)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        const auto nSize = holder->get().size();
+        const auto sDesc = containerDescription(holder->get()) + ((holder->isDiscardedByArenaRelease()) ? ", teardown by arena release" : ", teardown");
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
+        DFG_MODULE_NS(time)::TimerCpu timer;
+        holder.reset();
+        const auto elapsedTime = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), static_cast<double>(nSize));
+        std::cout << "Teardown time " << sDesc << ": " << elapsedTime << '\n';
+        if (resultTable(nRow, 6) == nullptr)
+        {
+            resultTable.setElement(nRow, 6, SzPtrAscii(toStrT<std::string>(nSize).c_str()));
+            resultTable.setElement(nRow, 7, SzPtrUtf8(sDesc.c_str()));
+        }
+        else
+            EXPECT_EQ(strTo<size_t>(resultTable(nRow, 6).c_str()), nSize);
+        resultTable.addString(floatingPointToStr<StringUtf8>(elapsedTime, 4 /*number of significant digits*/), nRow, resultTable.resultColumn());
+    }
+#endif // BENCH_HAS_PMR
+
     template <class Key_T, class Val_T>
     void insertPerformanceTesterUnsortedPush_sort_and_unique(DFG_MODULE_NS(cont)::MapVectorAoS<Key_T, Val_T>& cont, const unsigned long nRandEngSeed, const int nCount, const size_t nRow, BenchmarkResultTable& resultTable, const size_t capacity = DFG_ROOT_NS::NumericTraits<size_t>::maxValue)
     {
@@ -349,6 +663,8 @@ namespace
         auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
         randEng.seed(nRandEngSeed);
         cont.setSorting(false);
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
         DFG_MODULE_NS(time)::TimerCpu timer;
         for (int i = 0; i < nCount; ++i)
         {
@@ -358,28 +674,99 @@ namespace
         cont.setSorting(true);
         cont.m_storage.erase(std::unique(cont.m_storage.begin(), cont.m_storage.end(), [](const value_type& left, const value_type& right) {return left.first == right.first; }), cont.m_storage.end());
         const auto elapsedTime = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), nCount);
         const auto sReservationInfo = (capacity != NumericTraits<size_t>::maxValue) ? format_fmt(", reserved: {}: ", int(capacity >= cont.size())) : ": ";
         std::cout << "Insert time with MapVectorAoS push-sort-unique" << sReservationInfo  << elapsedTime << '\n';
         AddInsertPerformanceTimeElement(resultTable, elapsedTime, cont, sReservationInfo, nRow, DFG_ASCII("MapVectorAoS push-sort-unique"));
     }
 
-    template <class Cont_T>
-    size_t findPerformanceTester(Cont_T& cont, const unsigned long nRandEngSeed, const int nCount, const size_t nRow, BenchmarkResultTable& resultTable)
+    // Like insertPerformanceTesterUnsortedPush_sort_and_unique(), but sort and unique are done with bench::sortAndUniqueByKey().
+    // Map is kept in sorted mode: storage is unsorted only temporarily within the timed region, so no setSorting() calls are needed.
+    template <class Key_T, class Val_T>
+    void insertPerformanceTesterUnsortedPush_parallelSortAndUnique(DFG_MODULE_NS(cont)::MapVectorAoS<Key_T, Val_T>& cont, const unsigned long nRandEngSeed, const int nCount, const size_t nRow, BenchmarkResultTable& resultTable, const size_t capacity = DFG_ROOT_NS::NumericTraits<size_t>::maxValue)
     {
         using namespace DFG_ROOT_NS;
-        using namespace DFG_MODULE_NS(str);
+        typedef typename DFG_MODULE_NS(cont)::MapVectorAoS<Key_T, Val_T>::value_type value_type;
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(nRandEngSeed);
+        EXPECT_TRUE(cont.isSorted());
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
+        DFG_MODULE_NS(time)::TimerCpu timer;
+        for (int i = 0; i < nCount; ++i)
+        {
+            auto key = generateKey(randEng);
+            cont.m_storage.push_back(value_type(key, key));
+        }
+        bench::sortAndUniqueByKey(cont.m_storage, [](const value_type& a) { return a.first; });
+        const auto elapsedTime = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), nCount);
+        const auto sReservationInfo = (capacity != NumericTraits<size_t>::maxValue) ? format_fmt(", reserved: {}: ", int(capacity >= cont.size())) : ": ";
+        const auto sDesc = std::string("MapVectorAoS push-sort-unique (parallel radix sort)");
+        std::cout << "Insert time with " << sDesc << sReservationInfo << elapsedTime << '\n';
+        AddInsertPerformanceTimeElement(resultTable, elapsedTime, cont, sReservationInfo, nRow, SzPtrAscii(sDesc.c_str()));
+    }
 
+    // Bulk build of MapVectorSoA: items are pushed to a key-value pair buffer, which is sorted and made unique with
+    // bench::sortAndUniqueByKey() and then inserted to the map in key order, so every insert appends to the end of both
+    // key and value storage instead of moving existing elements.
+    template <class Key_T, class Val_T>
+    void insertPerformanceTesterBulkBuild_parallelSortAndUnique(DFG_MODULE_NS(cont)::MapVectorSoA<Key_T, Val_T>& cont, const unsigned long nRandEngSeed, const int nCount, const size_t nRow, BenchmarkResultTable& resultTable, const size_t capacity = DFG_ROOT_NS::NumericTraits<size_t>::maxValue)
+    {
+        using namespace DFG_ROOT_NS;
+        typedef std::pair<Key_T, Val_T> value_type;
         auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
         randEng.seed(nRandEngSeed);
+        EXPECT_TRUE(cont.isSorted());
+        EXPECT_TRUE(cont.empty());
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
         DFG_MODULE_NS(time)::TimerCpu timer;
-        size_t nFound = 0;
+        std::vector<value_type> buffer;
+        buffer.reserve(static_cast<size_t>(nCount));
         for (int i = 0; i < nCount; ++i)
         {
-            auto key = DFG_MODULE_NS(rand)::rand<int>(randEng, -10000000, 10000000);
-            nFound += (cont.find(key) != cont.end());
+            auto key = generateKey(randEng);
+            buffer.push_back(value_type(key, key));
+        }
+        bench::sortAndUniqueByKey(buffer, [](const value_type& a) { return a.first; });
+        for (const auto& item : buffer)
+            cont.insert(item.first, item.second);
+        const auto elapsedTime = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), nCount);
+        const auto sReservationInfo = (capacity != NumericTraits<size_t>::maxValue) ? format_fmt(", reserved: {}: ", int(capacity >= cont.size())) : ": ";
+        const auto sDesc = std::string("MapVectorSoA bulk build (parallel radix sort, sorted append)");
+        std::cout << "Insert time with " << sDesc << sReservationInfo << elapsedTime << '\n';
+        AddInsertPerformanceTimeElement(resultTable, elapsedTime, cont, sReservationInfo, nRow, SzPtrAscii(sDesc.c_str()));
+    }
+
+    template <class Cont_T>
+    size_t findPerformanceTester(Cont_T& cont, const std::vector<int>& findKeys, const size_t nRow, BenchmarkResultTable& resultTable)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+
+        const auto nCount = findKeys.size();
+        bench::LatencySampler latencySampler(bench::latencySampleIntervalFromEnvironment());
+        bench::PerfCounters perfCounters(resultTable.hasPerfCounterColumns());
+        perfCounters.start();
+        DFG_MODULE_NS(time)::TimerCpu timer;
+        size_t nFound = 0;
+        if (latencySampler.enabled())
+        {
+            for (const auto key : findKeys)
+                nFound += latencySampler.measure([&] { return cont.find(key) != cont.end(); });
+        }
+        else
+        {
+            for (const auto key : findKeys)
+                nFound += (cont.find(key) != cont.end());
         }
         const auto elapsed = timer.elapsedWallSeconds();
+        resultTable.setPerfCounterValues(static_cast<DFG_ROOT_NS::uint32>(nRow), perfCounters.stop(), static_cast<double>(nCount));
         std::cout << "Find time with " << containerDescription(cont) << ": " << elapsed << '\n';
+        if (latencySampler.enabled())
+            std::cout << "Find latency with " << containerDescription(cont) << ": " << bench::latencyPercentilesDescription(latencySampler.percentiles()) << '\n';
         std::cout << "Container size: " << cont.size() << '\n';
         std::cout << "Found item count: " << nFound << '\n';
         
@@ -400,12 +787,30 @@ namespace
 
         if (resultTable(nRow, 8) == nullptr)
             resultTable.setElement(nRow, 8, SzPtrUtf8((containerDescription(cont)).c_str()));
-        resultTable.addString(floatingPointToStr<StringUtf8>(elapsed, 4 /*number of significant digits*/), nRow, resultTable.colCountByMaxColIndex() - 1);
+        resultTable.addString(floatingPointToStr<StringUtf8>(elapsed, 4 /*number of significant digits*/), nRow, resultTable.resultColumn());
 
         return nFound;
     }
 }
 
+namespace
+{
+    // Returns nCount find keys for map with given sorted keys from bench::generateKeyStream(); misses are random keys in the
+    // range of generateKey() that are not in sortedKeys.
+    std::vector<int> generateFindKeys(const std::vector<int>& sortedKeys, const size_t nCount, const bench::KeyStreamParams& params, decltype(DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded())& randEng)
+    {
+        return bench::generateKeyStream<int>(sortedKeys.size(), nCount, params, randEng, [&](const size_t i) { return sortedKeys[i]; }, [&](auto& re)
+        {
+            for (;;)
+            {
+                const auto key = DFG_MODULE_NS(rand)::rand<int>(re, -10000000, 10000000);
+                if (!std::binary_search(sortedKeys.begin(), sortedKeys.end(), key))
+                    return key;
+            }
+        });
+    }
+} // unnamed namespace
+
 namespace
 {
     template <class Key_T, class Val_T>
@@ -430,6 +835,13 @@ namespace
         {
             return left == right;
         }
+
+        // For element references of MapVectorSoA, which are not pair objects but have first and second.
+        template <class Left_T, class Right_T>
+        bool operator()(const Left_T& left, const Right_T& right) const
+        {
+            return left.first == right.first && left.second == right.second;
+        }
     };
 }
 
@@ -446,7 +858,10 @@ TEST(dfgCont, MapVectorPerformance)
     const auto nCount = 50000;
 #endif
     const auto nFindCount = 5 * nCount;
-    const auto nIterationCount = 5;
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    // Rows 19 onwards have std::pmr::map and std::pmr::unordered_map insert and teardown for every memory resource.
+    const int nPmrRowCount = (BENCH_HAS_PMR) ? 4 * static_cast<int>(std::size(bench::allAllocatorKinds)) : 0;
+    const int nInsertRowCount = 18 + nPmrRowCount;
 
     BenchmarkResultTable table;
     table.addString(DFG_ASCII("Date"), 0, 0);
@@ -457,7 +872,7 @@ TEST(dfgCont, MapVectorPerformance)
     table.addString(DFG_ASCII("Insert count"), 0, 5);
     table.addString(DFG_ASCII("Inserted count"), 0, 6);
     table.addString(DFG_ASCII("Test type"), 0, 7);
-    const auto nLastStaticColumn = 7;
+    const auto nLastStaticColumn = 7 + table.addPerfCounterColumns(8);
 
     BenchmarkResultTable tableFindBench;
     tableFindBench.addString(DFG_ASCII("Date"), 0, 0);
@@ -469,18 +884,25 @@ TEST(dfgCont, MapVectorPerformance)
     tableFindBench.addString(DFG_ASCII("Find count"), 0, 6);
     tableFindBench.addString(DFG_ASCII("Found count"), 0, 7);
     tableFindBench.addString(DFG_ASCII("Test type"), 0, 8);
-    const auto nLastStaticColumnFindBench = 8;
+    tableFindBench.addString(DFG_ASCII("Key stream"), 0, 9);
+    const auto nLastStaticColumnFindBench = 9 + tableFindBench.addPerfCounterColumns(10);
+    // Find keys are generated with common/keyStream.hpp, parameters can be set through environment variables.
+    const auto findKeyStreamParams = bench::keyStreamParamsFromEnvironment();
 
-    for(size_t i = 0; i<nIterationCount; ++i)
+    const auto maxRelativeCi = [&]()
+    {
+        return (std::max)(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1), tableFindBench.maxRelativeCiHalfWidth(nLastStaticColumnFindBench + 1));
+    };
+    for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(maxRelativeCi()))
     {
-        if (i == 0)
+        if (repetitions.iterationIndex() == 0)
         {
             const StringUtf8 sTime(SzPtrUtf8(DFG_MODULE_NS(time)::localDate_yyyy_mm_dd_C().c_str()));
             const auto sCompiler = SzPtrUtf8(DFG_COMPILER_NAME_SIMPLE);
             const StringUtf8 sPointerSize(SzPtrUtf8(DFG_MODULE_NS(str)::toStrC(sizeof(void*)).c_str()));
             const auto sBuildType = SzPtrUtf8(DFG_BUILD_DEBUG_RELEASE_TYPE);
             const StringUtf8 sInsertCount(SzPtrUtf8(DFG_MODULE_NS(str)::toStrC(nCount).c_str()));
-            for (int et = 1; et <= 15; ++et)
+            for (int et = 1; et <= nInsertRowCount; ++et)
             {
                 const auto r = table.rowCountByMaxRowIndex();
                 table.addString(sTime, r, 0);
@@ -490,24 +912,27 @@ TEST(dfgCont, MapVectorPerformance)
                 table.addString(sInsertCount, r, 5);
             }
 
-            for (int et = 1; et <= 11; ++et)
+            const StringUtf8 sKeyStream(SzPtrUtf8(bench::keyStreamParamsDescription(findKeyStreamParams).c_str()));
+            for (int et = 1; et <= 18; ++et)
             {
                 const auto r = tableFindBench.rowCountByMaxRowIndex();
                 tableFindBench.addString(sTime, r, 0);
                 tableFindBench.addString(sCompiler, r, 2);
                 tableFindBench.addString(sPointerSize, r, 3);
                 tableFindBench.addString(sBuildType, r, 4);
+                tableFindBench.addString(sKeyStream, r, 9);
             }
         }
 
-        table.addString(SzPtrUtf8(("Time#" + toStrC(i)).c_str()), 0, table.colCountByMaxColIndex());
-        tableFindBench.addString(SzPtrUtf8(("Time#" + toStrC(i)).c_str()), 0, tableFindBench.colCountByMaxColIndex());
+        table.beginIteration(repetitions.iterationLabel("Time"));
+        tableFindBench.beginIteration(repetitions.iterationLabel("Time"));
 
         std::vector<int> stdVecInterleaved; stdVecInterleaved.reserve(2 * nCount);
         boost::container::vector<int> boostVecInterleaved; boostVecInterleaved.reserve(2 * nCount);
         std::map<int, int> mStd;
         std::unordered_map<int, int> mStdUnordered;
         boost::container::flat_map<int, int> mBoostFlatMap; mBoostFlatMap.reserve(nCount);
+        bench::FlatHashMap<int, int> mFlatHashMap;
         MapVectorAoS<int, int> mAoS_rs; mAoS_rs.reserve(nCount);
         MapVectorAoS<int, int> mAoS_ns;
         MapVectorAoS<int, int> mAoS_ru; mAoS_ru.reserve(nCount); mAoS_ru.setSorting(false);
@@ -519,6 +944,8 @@ TEST(dfgCont, MapVectorPerformance)
 
         MapVectorAoS<int, int> mUniqueAoSInsert; mUniqueAoSInsert.reserve(nCount); mUniqueAoSInsert.setSorting(false);
         MapVectorAoS<int, int> mUniqueAoSInsertNotReserved; mUniqueAoSInsertNotReserved.setSorting(false);
+        MapVectorAoS<int, int> mUniqueAoSInsertParallelRadix; mUniqueAoSInsertParallelRadix.reserve(nCount);
+        MapVectorSoA<int, int> mSoABulkBuild; mSoABulkBuild.reserve(nCount);
 
 #define CALL_PERFORMANCE_TEST_DFGLIB(name, ROW) insertPerformanceTester(name, randEngSeed, nCount, ROW, table, name.capacity());
 
@@ -535,8 +962,11 @@ TEST(dfgCont, MapVectorPerformance)
         insertPerformanceTester(mBoostFlatMap, randEngSeed, nCount, 11, table);
         insertPerformanceTesterUnsortedPush_sort_and_unique(mUniqueAoSInsert, randEngSeed, nCount, 12, table, mUniqueAoSInsert.capacity());
         insertPerformanceTesterUnsortedPush_sort_and_unique(mUniqueAoSInsertNotReserved, randEngSeed, nCount, 13, table, mUniqueAoSInsertNotReserved.capacity());
-        insertForVectorPerformanceTester(stdVecInterleaved, randEngSeed, nCount, 14, table);
-        insertForVectorPerformanceTester(boostVecInterleaved, randEngSeed, nCount, 15, table);
+        insertPerformanceTesterBulkBuild_parallelSortAndUnique(mSoABulkBuild, randEngSeed, nCount, 14, table, mSoABulkBuild.capacity());
+        insertForVectorPerformanceTester(stdVecInterleaved, randEngSeed, nCount, 15, table);
+        insertForVectorPerformanceTester(boostVecInterleaved, randEngSeed, nCount, 16, table);
+        insertPerformanceTester(mFlatHashMap, randEngSeed, nCount, 17, table);
+        insertPerformanceTesterUnsortedPush_parallelSortAndUnique(mUniqueAoSInsertParallelRadix, randEngSeed, nCount, 18, table, mUniqueAoSInsertParallelRadix.capacity());
 
         EXPECT_EQ(mAoS_rs.size(), mAoS_ns.size());
         EXPECT_EQ(mAoS_rs.size(), mAoS_ru.size());
@@ -548,8 +978,11 @@ TEST(dfgCont, MapVectorPerformance)
         EXPECT_EQ(mAoS_rs.size(), mStd.size());
         EXPECT_EQ(mAoS_rs.size(), mStdUnordered.size());
         EXPECT_EQ(mAoS_rs.size(), mBoostFlatMap.size());
+        EXPECT_EQ(mAoS_rs.size(), mFlatHashMap.size());
         EXPECT_EQ(mAoS_rs.size(), mUniqueAoSInsert.size());
         EXPECT_EQ(mAoS_rs.size(), mUniqueAoSInsertNotReserved.size());
+        EXPECT_EQ(mAoS_rs.size(), mUniqueAoSInsertParallelRadix.size());
+        EXPECT_EQ(mAoS_rs.size(), mSoABulkBuild.size());
 
 #define DFG_TEMP_CHECK_EQUALITY(CONT) EXPECT_TRUE(std::equal(mAoS_ns.begin(), mAoS_ns.end(), CONT.begin(), ValueTypeCompareFunctor<int, int>()));
 
@@ -558,25 +991,67 @@ TEST(dfgCont, MapVectorPerformance)
         DFG_TEMP_CHECK_EQUALITY(mAoS_rs);
         DFG_TEMP_CHECK_EQUALITY(mUniqueAoSInsert); // This requires sort() to be result-wise identical to stable_sort() for the generated data.
         DFG_TEMP_CHECK_EQUALITY(mUniqueAoSInsertNotReserved); // This requires sort() to be result-wise identical to stable_sort() for the generated data.
+        DFG_TEMP_CHECK_EQUALITY(mUniqueAoSInsertParallelRadix);
+        DFG_TEMP_CHECK_EQUALITY(mSoABulkBuild);
         EXPECT_TRUE(std::equal(stdVecInterleaved.begin(), stdVecInterleaved.end(), boostVecInterleaved.begin()));
 
+#if BENCH_HAS_PMR
+        for (size_t nKind = 0; nKind < std::size(bench::allAllocatorKinds); ++nKind)
+        {
+            // Holders own the maps together with their resources so that teardown can be timed as a whole.
+            std::optional<bench::ResourceBackedContainer<std::pmr::map<int, int>>> mapHolder;
+            std::optional<bench::ResourceBackedContainer<std::pmr::unordered_map<int, int>>> unorderedMapHolder;
+            mapHolder.emplace(bench::allAllocatorKinds[nKind]);
+            unorderedMapHolder.emplace(bench::allAllocatorKinds[nKind]);
+            auto& mPmr = mapHolder->get();
+            auto& mPmrUnordered = unorderedMapHolder->get();
+            insertPerformanceTester(mPmr, randEngSeed, nCount, 19 + 4 * nKind, table);
+            insertPerformanceTester(mPmrUnordered, randEngSeed, nCount, 20 + 4 * nKind, table);
+            EXPECT_EQ(mAoS_rs.size(), mPmr.size());
+            EXPECT_EQ(mAoS_rs.size(), mPmrUnordered.size());
+            DFG_TEMP_CHECK_EQUALITY(mPmr);
+            teardownPerformanceTester(mapHolder, 21 + 4 * nKind, table);
+            teardownPerformanceTester(unorderedMapHolder, 22 + 4 * nKind, table);
+        }
+#endif // BENCH_HAS_PMR
+
 #undef DFG_TEMP_CHECK_EQUALITY
 
 #undef CALL_PERFORMANCE_TEST_DFGLIB
 
         {
-            const auto randEngSeedFind = randEngSeed * 2;
-            const auto findings = findPerformanceTester(mAoS_rs, randEngSeedFind, nFindCount, 1, tableFindBench);
-            EXPECT_EQ(findings, findPerformanceTester(mAoS_ns, randEngSeedFind, nFindCount, 2, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mAoS_ru, randEngSeedFind, nFindCount, 3, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mAoS_nu, randEngSeedFind, nFindCount, 4, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mSoA_rs, randEngSeedFind, nFindCount, 5, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mSoA_ns, randEngSeedFind, nFindCount, 6, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mSoA_ru, randEngSeedFind, nFindCount, 7, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mSoA_nu, randEngSeedFind, nFindCount, 8, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mStd, randEngSeedFind, nFindCount, 9, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mStdUnordered, randEngSeedFind, nFindCount, 10, tableFindBench));
-            EXPECT_EQ(findings, findPerformanceTester(mBoostFlatMap, randEngSeedFind, nFindCount, 11, tableFindBench));
+            std::vector<int> sortedKeys;
+            sortedKeys.reserve(mAoS_rs.size());
+            for (const auto& item : mAoS_rs)
+                sortedKeys.push_back(item.first);
+            auto randEngFind = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+            randEngFind.seed(randEngSeed * 2);
+            const auto findKeys = generateFindKeys(sortedKeys, nFindCount, findKeyStreamParams, randEngFind);
+            const auto findings = findPerformanceTester(mAoS_rs, findKeys, 1, tableFindBench);
+            EXPECT_EQ(findings, findPerformanceTester(mAoS_ns, findKeys, 2, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mAoS_ru, findKeys, 3, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mAoS_nu, findKeys, 4, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mSoA_rs, findKeys, 5, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mSoA_ns, findKeys, 6, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mSoA_ru, findKeys, 7, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mSoA_nu, findKeys, 8, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mStd, findKeys, 9, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mStdUnordered, findKeys, 10, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mBoostFlatMap, findKeys, 11, tableFindBench));
+            const SearchPolicyMapVectorSoAView<int, int, bench::LinearSimdSearch> simdFindSoA_ru(mSoA_ru);
+            const SearchPolicyMapVectorSoAView<int, int, bench::LinearSimdSearch> simdFindSoA_nu(mSoA_nu);
+            EXPECT_EQ(findings, findPerformanceTester(simdFindSoA_ru, findKeys, 12, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(simdFindSoA_nu, findKeys, 13, tableFindBench));
+            // Search policies for sorted lookup, rows 14 - 17.
+            const SearchPolicyMapVectorSoAView<int, int, bench::LowerBoundSearch> lowerBoundSoA_rs(mSoA_rs);
+            const SearchPolicyMapVectorSoAView<int, int, bench::BranchlessBinarySearch> branchlessSoA_rs(mSoA_rs);
+            const SearchPolicyMapVectorSoAView<int, int, bench::InterpolationSearch> interpolationSoA_rs(mSoA_rs);
+            const SearchPolicyMapVectorSoAView<int, int, bench::KarySimdSearch> karySoA_rs(mSoA_rs);
+            EXPECT_EQ(findings, findPerformanceTester(lowerBoundSoA_rs, findKeys, 14, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(branchlessSoA_rs, findKeys, 15, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(interpolationSoA_rs, findKeys, 16, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(karySoA_rs, findKeys, 17, tableFindBench));
+            EXPECT_EQ(findings, findPerformanceTester(mFlatHashMap, findKeys, 18, tableFindBench));
         }
     }
 
@@ -584,4 +1059,1281 @@ TEST(dfgCont, MapVectorPerformance)
     tableFindBench.addReducedValuesAndWriteToFile(nLastStaticColumnFindBench + 1, DFG_ASCII("benchmarkMapVectorFindPerformance"));
 }
 
+namespace
+{
+    // Returns nCount distinct keys from generateKey() in ascending order.
+    std::vector<int> generateSortedUniqueKeys(decltype(DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded())& re, const size_t nCount)
+    {
+        std::vector<int> keys;
+        keys.reserve(nCount);
+        while (keys.size() < nCount)
+        {
+            for (size_t n = keys.size(); n < nCount; ++n)
+                keys.push_back(generateKey(re));
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        }
+        return keys;
+    }
+
+    // Runs finds for all keys in findKeys through given search policy and adds ns/find to resultTable. Returns found count.
+    template <class SearchPolicy_T>
+    size_t searchPolicySweepTester(const DFG_MODULE_NS(cont)::MapVectorSoA<int, int>& cont, const std::vector<int>& findKeys, const size_t nRow, BenchmarkResultTable& resultTable)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        const SearchPolicyMapVectorSoAView<int, int, SearchPolicy_T> view(cont);
+        TimedRow timedRow(resultTable, nRow);
+        size_t nFound = 0;
+        for (const auto key : findKeys)
+            nFound += (view.find(key) != view.end());
+        const auto elapsed = timedRow.stop(static_cast<double>(findKeys.size()));
+
+        timedRow.record({ toStrC(cont.size()), toStrC(findKeys.size()), toStrC(nFound), SearchPolicy_T::name() }, { 7 }, 1e9 * elapsed / static_cast<double>(findKeys.size()));
+        return nFound;
+    }
+} // unnamed namespace
+
+// Find time of sorted MapVectorSoA<int, int> with every search policy in common/searchPolicies.hpp for a range of key counts.
+// Keys are uniformly distributed like in MapVectorPerformance; find keys are generated before timing.
+TEST(dfgCont, MapVectorSearchPolicySweep)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t nMaxKeyCount = size_t(1) << 12;
+    const size_t nFindCount = size_t(1) << 12;
+#else
+    const size_t nMaxKeyCount = size_t(1) << 22;
+    const size_t nFindCount = size_t(1) << 20;
+#endif
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const int nPolicyCount = 4;
+    const auto findKeyStreamParams = bench::keyStreamParamsFromEnvironment();
+
+    std::vector<size_t> keyCounts;
+    for (size_t nKeyCount = 16; nKeyCount <= nMaxKeyCount; nKeyCount *= 4)
+        keyCounts.push_back(nKeyCount);
+
+    BenchmarkResultTable table({ "Key count", "Find count", "Found count", "Search policy" }, keyCounts.size() * nPolicyCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1)))
+    {
+        table.beginIteration(repetitions.iterationLabel("ns/find"));
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(randEngSeed);
+        for (size_t nSize = 0; nSize < keyCounts.size(); ++nSize)
+        {
+            // Inserting sorted unique keys so that every insert is an append to sorted map.
+            const auto keys = generateSortedUniqueKeys(randEng, keyCounts[nSize]);
+            MapVectorSoA<int, int> m;
+            m.reserve(keys.size());
+            for (const auto key : keys)
+                m.insert(key, key);
+
+            const auto findKeys = generateFindKeys(keys, nFindCount, findKeyStreamParams, randEng);
+
+            const auto nFirstRow = 1 + nSize * nPolicyCount;
+            const auto nFound = searchPolicySweepTester<bench::LowerBoundSearch>(m, findKeys, nFirstRow, table);
+            EXPECT_EQ(nFound, searchPolicySweepTester<bench::BranchlessBinarySearch>(m, findKeys, nFirstRow + 1, table));
+            EXPECT_EQ(nFound, searchPolicySweepTester<bench::InterpolationSearch>(m, findKeys, nFirstRow + 2, table));
+            EXPECT_EQ(nFound, searchPolicySweepTester<bench::KarySimdSearch>(m, findKeys, nFirstRow + 3, table));
+        }
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapVectorSearchPolicySweep"));
+}
+
+namespace
+{
+    // Passes findKeys to findFunc(pKeys, nCount) in batches of nBatchSize keys and adds ns/find to resultTable.
+    // findFunc returns the number of found keys in the batch; total found count is returned.
+    template <class FindFunc_T>
+    size_t batchFindTester(const std::string& sDesc, const size_t nKeyCount, const std::vector<int>& findKeys, const size_t nBatchSize, const size_t nRow, BenchmarkResultTable& resultTable, FindFunc_T&& findFunc)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        TimedRow timedRow(resultTable, nRow);
+        size_t nFound = 0;
+        for (size_t nFirst = 0; nFirst < findKeys.size(); nFirst += nBatchSize)
+            nFound += findFunc(findKeys.data() + nFirst, std::min(nBatchSize, findKeys.size() - nFirst));
+        const auto elapsed = timedRow.stop(static_cast<double>(findKeys.size()));
+        std::cout << "Find time with " << sDesc << ", batch size " << nBatchSize << ": " << elapsed << '\n';
+
+        timedRow.record({ toStrC(nKeyCount), toStrC(findKeys.size()), toStrC(nBatchSize), toStrC(nFound), sDesc }, { 8 }, 1e9 * elapsed / static_cast<double>(findKeys.size()));
+        return nFound;
+    }
+} // unnamed namespace
+
+// Compares one-at-a-time find to batched find (BranchlessBinarySearch::findBatch() over sorted MapVectorSoA keys and
+// bench::FlatHashMap::findBatch()) with a map that fits in cache and with one that is much bigger than typical LLC.
+// Batch sizes are the sizes in which keys are passed to batched find, like request batches in a service.
+TEST(dfgCont, MapVectorBatchFindPerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t keyCounts[] = { size_t(1) << 10, size_t(1) << 12 };
+    const size_t nFindCount = size_t(1) << 12;
+#else
+    const size_t keyCounts[] = { size_t(1) << 16, size_t(1) << 23 };
+    const size_t nFindCount = size_t(1) << 22;
+#endif
+    const size_t batchSizes[] = { 64, 256, 1024 };
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nRowsPerKeyCount = 3 + 2 * std::size(batchSizes);
+    const auto findKeyStreamParams = bench::keyStreamParamsFromEnvironment();
+
+    BenchmarkResultTable table({ "Key count", "Find count", "Batch size", "Found count", "Test type" }, std::size(keyCounts) * nRowsPerKeyCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    for (size_t nKeyCountIndex = 0; nKeyCountIndex < std::size(keyCounts); ++nKeyCountIndex)
+    {
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(randEngSeed);
+        const auto keys = generateSortedUniqueKeys(randEng, keyCounts[nKeyCountIndex]);
+        MapVectorSoA<int, int> mSoA;
+        mSoA.reserve(keys.size());
+        bench::FlatHashMap<int, int> mFlatHashMap;
+        mFlatHashMap.reserve(keys.size());
+        std::unordered_map<int, int> mStdUnordered;
+        mStdUnordered.reserve(keys.size());
+        for (const auto key : keys)
+        {
+            mSoA.insert(key, key);
+            mFlatHashMap.insert(std::pair<int, int>(key, key));
+            mStdUnordered.insert(std::pair<int, int>(key, key));
+        }
+        const auto findKeys = generateFindKeys(keys, nFindCount, findKeyStreamParams, randEng);
+
+        const auto soaKeys = mSoA.keyRange();
+        const int* pSoaKeys = std::to_address(soaKeys.begin());
+        std::vector<size_t> indexResults(batchSizes[std::size(batchSizes) - 1]);
+        std::vector<const std::pair<int, int>*> pointerResults(indexResults.size());
+
+        const auto nFirstRow = static_cast<uint32>(1 + nKeyCountIndex * nRowsPerKeyCount);
+        for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1, nFirstRow, nFirstRow + static_cast<uint32>(nRowsPerKeyCount))))
+        {
+            table.beginIteration(repetitions.iterationLabel("ns/find"));
+            auto nRow = 1 + nKeyCountIndex * nRowsPerKeyCount;
+            const auto nFound = batchFindTester(containerDescription(mSoA) + ", find()", keys.size(), findKeys, 1, nRow++, table, [&](const int* pKeys, size_t)
+            {
+                return size_t(mSoA.find(*pKeys) != mSoA.end());
+            });
+            EXPECT_EQ(nFound, batchFindTester(containerDescription(mSoA) + ", find: " + bench::BranchlessBinarySearch::name(), keys.size(), findKeys, 1, nRow++, table, [&](const int* pKeys, size_t)
+            {
+                return size_t(bench::BranchlessBinarySearch::find(pSoaKeys, mSoA.size(), *pKeys) != mSoA.size());
+            }));
+            for (const auto nBatchSize : batchSizes)
+            {
+                EXPECT_EQ(nFound, batchFindTester(containerDescription(mSoA) + ", findBatch: " + bench::BranchlessBinarySearch::name(), keys.size(), findKeys, nBatchSize, nRow++, table, [&](const int* pKeys, const size_t nCount)
+                {
+                    bench::findBatch<bench::BranchlessBinarySearch>(pSoaKeys, mSoA.size(), pKeys, nCount, indexResults.data());
+                    return static_cast<size_t>(std::count_if(indexResults.begin(), indexResults.begin() + nCount, [&](const size_t nIndex) { return nIndex != mSoA.size(); }));
+                }));
+            }
+            EXPECT_EQ(nFound, batchFindTester(containerDescription(mFlatHashMap) + ", find()", keys.size(), findKeys, 1, nRow++, table, [&](const int* pKeys, size_t)
+            {
+                return size_t(mFlatHashMap.find(*pKeys) != mFlatHashMap.end());
+            }));
+            for (const auto nBatchSize : batchSizes)
+            {
+                EXPECT_EQ(nFound, batchFindTester(containerDescription(mFlatHashMap) + ", findBatch()", keys.size(), findKeys, nBatchSize, nRow++, table, [&](const int* pKeys, const size_t nCount)
+                {
+                    mFlatHashMap.findBatch(pKeys, nCount, pointerResults.data());
+                    return static_cast<size_t>(std::count_if(pointerResults.begin(), pointerResults.begin() + nCount, [](const std::pair<int, int>* p) { return p != nullptr; }));
+                }));
+            }
+            EXPECT_EQ(nFound, batchFindTester(containerDescription(mStdUnordered) + ", find()", keys.size(), findKeys, 1, nRow++, table, [&](const int* pKeys, size_t)
+            {
+                return size_t(mStdUnordered.find(*pKeys) != mStdUnordered.end());
+            }));
+        }
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapVectorBatchFindPerformance"));
+}
+
+#if BENCH_HAS_COROUTINES
+
+namespace
+{
+    // Runs findFunc(pKeys, nCount, nGroupSize) for all findKeys and adds ns/find to resultTable; group size 0 means plain find().
+    // bestTime is updated to the smallest elapsed time seen. Returns found count.
+    template <class FindFunc_T>
+    size_t interleavedFindTester(const std::string& sDesc, const size_t nKeyCount, const std::vector<int>& findKeys, const size_t nGroupSize, const size_t nRow, BenchmarkResultTable& resultTable, double& bestTime, FindFunc_T&& findFunc)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        TimedRow timedRow(resultTable, nRow);
+        const size_t nFound = findFunc(findKeys.data(), findKeys.size(), nGroupSize);
+        const auto elapsed = timedRow.stop(static_cast<double>(findKeys.size()));
+        bestTime = (std::min)(bestTime, elapsed);
+        std::cout << "Find time with " << sDesc << ", group size " << nGroupSize << ": " << elapsed << '\n';
+
+        timedRow.record({ toStrC(nKeyCount), toStrC(findKeys.size()), toStrC(nGroupSize), toStrC(nFound), sDesc }, { 8 }, 1e9 * elapsed / static_cast<double>(findKeys.size()));
+        return nFound;
+    }
+} // unnamed namespace
+
+// Compares plain find() to coroutine-interleaved lookups (common/interleavedLookup.hpp) where a group of lookups is kept
+// in flight and each lookup suspends after prefetching its next node or search midpoint. Find keys come from
+// generateFindKeys() like in MapVectorPerformance. Best group size of every container is printed at the end.
+// Note: key count is limited by generateKey() domain of about 2e7 distinct keys; 1e7 keys in std::map take roughly 0.5 GB.
+TEST(dfgCont, MapCoroutineInterleavedFindPerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t keyCounts[] = { size_t(1) << 10, size_t(1) << 12 };
+    const size_t nFindCount = size_t(1) << 12;
+#else
+    const size_t keyCounts[] = { 1000000, 10000000 };
+    const size_t nFindCount = size_t(1) << 22;
+#endif
+    const size_t groupSizes[] = { 1, 2, 4, 8, 16, 32, 64 };
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nContainerCount = 4;
+    const size_t nRowsPerContainer = 1 + std::size(groupSizes);
+    const size_t nRowsPerKeyCount = nContainerCount * nRowsPerContainer;
+
+    BenchmarkResultTable table({ "Key count", "Find count", "Group size", "Found count", "Test type" }, std::size(keyCounts) * nRowsPerKeyCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    const auto findKeyStreamParams = bench::keyStreamParamsFromEnvironment();
+
+    std::string sBestGroupSizes;
+    for (size_t nKeyCountIndex = 0; nKeyCountIndex < std::size(keyCounts); ++nKeyCountIndex)
+    {
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(randEngSeed);
+        const auto keys = generateSortedUniqueKeys(randEng, keyCounts[nKeyCountIndex]);
+        const auto findKeys = generateFindKeys(keys, nFindCount, findKeyStreamParams, randEng);
+        std::map<int, int> mStd;
+        boost::container::flat_map<int, int> mBoostFlatMap;
+        mBoostFlatMap.reserve(keys.size());
+        MapVectorAoS<int, int> mAoS;
+        mAoS.reserve(keys.size());
+        MapVectorSoA<int, int> mSoA;
+        mSoA.reserve(keys.size());
+        for (const auto key : keys)
+        {
+            mStd.insert(mStd.end(), std::pair<int, int>(key, key));
+            mBoostFlatMap.insert(mBoostFlatMap.end(), std::pair<int, int>(key, key));
+            mAoS.insert(key, key);
+            mSoA.insert(key, key);
+        }
+        ASSERT_EQ(keys.size(), mStd.size());
+        ASSERT_EQ(keys.size(), mBoostFlatMap.size());
+        ASSERT_EQ(keys.size(), mAoS.size());
+        ASSERT_EQ(keys.size(), mSoA.size());
+
+        const auto pFlatMapData = &*mBoostFlatMap.begin();
+        const auto pAoSData = mAoS.m_storage.data();
+        const int* pSoAKeys = std::to_address(mSoA.keyRange().begin());
+        const auto keyOfPair = [](const auto& item) { return item.first; };
+        const auto keyOfKey = [](const int key) { return key; };
+
+        const std::string containerNames[nContainerCount] =
+        {
+            containerDescription(mStd) + ((BENCH_HAS_STD_MAP_NODE_ACCESS) ? "" : " (no node access, plain find)"),
+            containerDescription(mBoostFlatMap),
+            containerDescription(mAoS),
+            containerDescription(mSoA)
+        };
+        const auto interleavedFind = [&](const size_t nContainer, const int* pKeys, const size_t nCount, const size_t nGroupSize) -> size_t
+        {
+            switch (nContainer)
+            {
+                case 0:  return bench::runInterleavedLookups(pKeys, nCount, nGroupSize, [&](const int key) { return bench::lookupStdMap(mStd, key); });
+                case 1:  return bench::runInterleavedLookups(pKeys, nCount, nGroupSize, [&](const int key) { return bench::lookupSorted(pFlatMapData, mBoostFlatMap.size(), key, keyOfPair); });
+                case 2:  return bench::runInterleavedLookups(pKeys, nCount, nGroupSize, [&](const int key) { return bench::lookupSorted(pAoSData, mAoS.size(), key, keyOfPair); });
+                default: return bench::runInterleavedLookups(pKeys, nCount, nGroupSize, [&](const int key) { return bench::lookupSorted(pSoAKeys, mSoA.size(), key, keyOfKey); });
+            }
+        };
+        const auto plainFind = [&](const size_t nContainer, const int* pKeys, const size_t nCount) -> size_t
+        {
+            const auto countFound = [&](auto& cont)
+            {
+                size_t nFound = 0;
+                for (size_t i = 0; i < nCount; ++i)
+                    nFound += (cont.find(pKeys[i]) != cont.end());
+                return nFound;
+            };
+            switch (nContainer)
+            {
+                case 0:  return countFound(mStd);
+                case 1:  return countFound(mBoostFlatMap);
+                case 2:  return countFound(mAoS);
+                default: return countFound(mSoA);
+            }
+        };
+
+        std::vector<double> bestTimes(nRowsPerKeyCount, std::numeric_limits<double>::infinity());
+        const auto nKeyCountFirstRow = static_cast<uint32>(1 + nKeyCountIndex * nRowsPerKeyCount);
+        for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1, nKeyCountFirstRow, nKeyCountFirstRow + static_cast<uint32>(nRowsPerKeyCount))))
+        {
+            table.beginIteration(repetitions.iterationLabel("ns/find"));
+            size_t nFound = NumericTraits<size_t>::maxValue;
+            for (size_t nContainer = 0; nContainer < nContainerCount; ++nContainer)
+            {
+                const auto nFirstRow = nContainer * nRowsPerContainer;
+                const auto nContainerFound = interleavedFindTester(containerNames[nContainer] + ", find()", keys.size(), findKeys, 0, 1 + nKeyCountIndex * nRowsPerKeyCount + nFirstRow, table, bestTimes[nFirstRow], [&](const int* pKeys, const size_t nCount, size_t)
+                {
+                    return plainFind(nContainer, pKeys, nCount);
+                });
+                if (nFound == NumericTraits<size_t>::maxValue)
+                    nFound = nContainerFound;
+                EXPECT_EQ(nFound, nContainerFound);
+                for (size_t nGroup = 0; nGroup < std::size(groupSizes); ++nGroup)
+                {
+                    const auto nRowInKeyCount = nFirstRow + 1 + nGroup;
+                    EXPECT_EQ(nFound, interleavedFindTester(containerNames[nContainer] + ", coroutine-interleaved", keys.size(), findKeys, groupSizes[nGroup], 1 + nKeyCountIndex * nRowsPerKeyCount + nRowInKeyCount, table, bestTimes[nRowInKeyCount], [&](const int* pKeys, const size_t nCount, const size_t nGroupSize)
+                    {
+                        return interleavedFind(nContainer, pKeys, nCount, nGroupSize);
+                    }));
+                }
+            }
+        }
+
+        for (size_t nContainer = 0; nContainer < nContainerCount; ++nContainer)
+        {
+            const auto iterGroupBegin = bestTimes.begin() + static_cast<std::ptrdiff_t>(nContainer * nRowsPerContainer + 1);
+            const auto iterBest = std::min_element(iterGroupBegin, iterGroupBegin + static_cast<std::ptrdiff_t>(std::size(groupSizes)));
+            sBestGroupSizes += format_fmt("{}, key count {}: best group size {} ({:.1f} ns/find, plain find() {:.1f} ns/find)\n",
+                                          containerNames[nContainer],
+                                          keys.size(),
+                                          groupSizes[iterBest - iterGroupBegin],
+                                          1e9 * *iterBest / static_cast<double>(nFindCount),
+                                          1e9 * *(iterGroupBegin - 1) / static_cast<double>(nFindCount));
+        }
+    }
+    std::cout << sBestGroupSizes;
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapCoroutineInterleavedFindPerformance"));
+}
+
+#endif // BENCH_HAS_COROUTINES
+
+namespace
+{
+    // Copies initial to new container, reserves room for all inserts and calls insertFunc(cont, nFirst, nCount) for
+    // consecutive batches of nBatchSize inserts. Adds ns/insert to resultTable and returns the container.
+    template <class Cont_T, class InsertFunc_T>
+    Cont_T batchInsertTester(const std::string& sDesc, const Cont_T& initial, const size_t nInsertCount, const size_t nBatchSize, const size_t nRow, BenchmarkResultTable& resultTable, InsertFunc_T&& insertFunc)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        Cont_T cont = initial;
+        cont.reserve(initial.size() + nInsertCount);
+        TimedRow timedRow(resultTable, nRow);
+        for (size_t nFirst = 0; nFirst < nInsertCount; nFirst += nBatchSize)
+            insertFunc(cont, nFirst, std::min(nBatchSize, nInsertCount - nFirst));
+        const auto elapsed = timedRow.stop(static_cast<double>(nInsertCount));
+        std::cout << "Insert time with " << sDesc << ", batch size " << nBatchSize << ": " << elapsed << '\n';
+
+        timedRow.record({ toStrC(initial.size()), toStrC(nInsertCount), toStrC(nBatchSize), toStrC(cont.size()), sDesc }, { 8 }, 1e9 * elapsed / static_cast<double>(nInsertCount));
+        return cont;
+    }
+} // unnamed namespace
+
+// Compares one-by-one inserts to batched inserts of common/batchInsert.hpp: random position inserts to std::vector<int>
+// and key inserts to MapVectorAoS and boost::flat_map, for batch sizes from 1 to 4096. Batches are sorted before timing
+// (vector batches by position, map batches by key with duplicates removed) so that both variants get the same input and
+// produce the same result.
+TEST(dfgCont, MapVectorBatchInsertPerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t nInitialSize = 1000;
+    const size_t nInsertCount = 512;
+#else
+    const size_t nInitialSize = 50000;
+    const size_t nInsertCount = 8192;
+#endif
+    const size_t batchSizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nRowsPerBatchSize = 6;
+
+    BenchmarkResultTable table({ "Initial size", "Insert count", "Batch size", "Final size", "Test type" }, std::size(batchSizes) * nRowsPerBatchSize);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    using MapAoS = MapVectorAoS<int, int>;
+    using BoostFlatMap = boost::container::flat_map<int, int>;
+    auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+    randEng.seed(randEngSeed);
+    std::vector<int> initialVec;
+    MapAoS initialAoS;
+    BoostFlatMap initialFlatMap;
+    for (size_t i = 0; i < nInitialSize; ++i)
+    {
+        const auto key = generateKey(randEng);
+        initialVec.push_back(key);
+        initialAoS.insert(key, key);
+        initialFlatMap.insert(std::pair<int, int>(key, key));
+    }
+    std::vector<int> insertKeys(nInsertCount);
+    for (auto& key : insertKeys)
+        key = generateKey(randEng);
+
+    for (size_t nBatchIndex = 0; nBatchIndex < std::size(batchSizes); ++nBatchIndex)
+    {
+        const auto nBatchSize = batchSizes[nBatchIndex];
+
+        // Vector batches: positions are relative to the vector size at the start of the batch and sorted within the batch.
+        std::vector<size_t> positions(nInsertCount);
+        std::vector<int> positionValues(nInsertCount);
+        // Map batches: sorted by key, duplicates within the batch removed; batchEnds[b] is the end of batch b in mapBatches.
+        std::vector<MapAoS::value_type> mapBatches;
+        std::vector<size_t> batchEnds;
+        for (size_t nFirst = 0; nFirst < nInsertCount; nFirst += nBatchSize)
+        {
+            const auto nEnd = std::min(nInsertCount, nFirst + nBatchSize);
+            std::vector<std::pair<size_t, int>> batch;
+            for (size_t i = nFirst; i < nEnd; ++i)
+                batch.emplace_back(static_cast<size_t>(DFG_MODULE_NS(rand)::rand<int>(randEng, 0, static_cast<int>(nInitialSize + nFirst))), insertKeys[i]);
+            std::stable_sort(batch.begin(), batch.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (size_t i = nFirst; i < nEnd; ++i)
+                std::tie(positions[i], positionValues[i]) = batch[i - nFirst];
+
+            std::vector<int> batchKeys(insertKeys.begin() + static_cast<std::ptrdiff_t>(nFirst), insertKeys.begin() + static_cast<std::ptrdiff_t>(nEnd));
+            std::sort(batchKeys.begin(), batchKeys.end());
+            batchKeys.erase(std::unique(batchKeys.begin(), batchKeys.end()), batchKeys.end());
+            for (const auto key : batchKeys)
+                mapBatches.push_back(MapAoS::value_type(key, key));
+            batchEnds.push_back(mapBatches.size());
+        }
+        const auto mapBatchRange = [&](const size_t nFirst)
+        {
+            const auto nBatch = nFirst / nBatchSize;
+            const auto nBegin = (nBatch == 0) ? 0 : batchEnds[nBatch - 1];
+            return std::make_pair(mapBatches.data() + nBegin, batchEnds[nBatch] - nBegin);
+        };
+        const auto keyOfPair = [](const auto& item) { return item.first; };
+
+        const auto nFirstRow = static_cast<uint32>(1 + nBatchIndex * nRowsPerBatchSize);
+        for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1, nFirstRow, nFirstRow + static_cast<uint32>(nRowsPerBatchSize))))
+        {
+            table.beginIteration(repetitions.iterationLabel("ns/insert"));
+            auto nRow = 1 + nBatchIndex * nRowsPerBatchSize;
+
+            const auto vecOneByOne = batchInsertTester(containerDescription(initialVec) + ", insert() one by one", initialVec, nInsertCount, nBatchSize, nRow++, table, [&](std::vector<int>& cont, const size_t nFirst, const size_t nCount)
+            {
+                for (size_t j = 0; j < nCount; ++j)
+                    cont.insert(cont.begin() + static_cast<std::ptrdiff_t>(positions[nFirst + j] + j), positionValues[nFirst + j]);
+            });
+            const auto vecBatch = batchInsertTester(containerDescription(initialVec) + ", insertBatch()", initialVec, nInsertCount, nBatchSize, nRow++, table, [&](std::vector<int>& cont, const size_t nFirst, const size_t nCount)
+            {
+                bench::insertBatch(cont, positions.data() + nFirst, positionValues.data() + nFirst, nCount);
+            });
+            EXPECT_EQ(vecOneByOne, vecBatch);
+
+            const auto aosOneByOne = batchInsertTester(containerDescription(initialAoS) + ", insert() one by one", initialAoS, nInsertCount, nBatchSize, nRow++, table, [&](MapAoS& cont, const size_t nFirst, const size_t)
+            {
+                const auto batch = mapBatchRange(nFirst);
+                for (size_t j = 0; j < batch.second; ++j)
+                    cont.insert(batch.first[j].first, batch.first[j].second);
+            });
+            const auto aosBatch = batchInsertTester(containerDescription(initialAoS) + ", insertBatchSorted()", initialAoS, nInsertCount, nBatchSize, nRow++, table, [&](MapAoS& cont, const size_t nFirst, const size_t)
+            {
+                const auto batch = mapBatchRange(nFirst);
+                bench::insertBatchSorted(cont.m_storage, batch.first, batch.second, keyOfPair);
+            });
+            EXPECT_EQ(aosOneByOne.size(), aosBatch.size());
+            EXPECT_TRUE(std::equal(aosOneByOne.begin(), aosOneByOne.end(), aosBatch.begin(), aosBatch.end()));
+
+            const auto flatMapOneByOne = batchInsertTester(containerDescription(initialFlatMap) + ", insert() one by one", initialFlatMap, nInsertCount, nBatchSize, nRow++, table, [&](BoostFlatMap& cont, const size_t nFirst, const size_t)
+            {
+                const auto batch = mapBatchRange(nFirst);
+                for (size_t j = 0; j < batch.second; ++j)
+                    cont.insert(std::pair<int, int>(batch.first[j].first, batch.first[j].second));
+            });
+            const auto flatMapBatch = batchInsertTester(containerDescription(initialFlatMap) + ", insertBatchSorted()", initialFlatMap, nInsertCount, nBatchSize, nRow++, table, [&](BoostFlatMap& cont, const size_t nFirst, const size_t)
+            {
+                // Merges directly to the underlying sequence; extract and adopt only move the sequence.
+                const auto batch = mapBatchRange(nFirst);
+                auto sequence = cont.extract_sequence();
+                bench::insertBatchSorted(sequence, batch.first, batch.second, keyOfPair);
+                cont.adopt_sequence(boost::container::ordered_unique_range, std::move(sequence));
+            });
+            EXPECT_TRUE(flatMapOneByOne == flatMapBatch);
+            EXPECT_EQ(aosBatch.size(), flatMapBatch.size());
+        }
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapVectorBatchInsertPerformance"));
+}
+
+namespace
+{
+    // Calls findValue(psz) for lookupStrings[i] for every i in lookupIndexes and adds time to resultTable. findValue returns
+    // pointer to mapped value or nullptr; returns sum of found values.
+    template <class FindFunc_T>
+    int64_t staticKeyFindTester(const std::string& sDesc, const size_t nKeyCount, const std::vector<const char*>& lookupStrings, const std::vector<uint8_t>& lookupIndexes, const size_t nRow, BenchmarkResultTable& resultTable, FindFunc_T&& findValue)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        TimedRow timedRow(resultTable, nRow);
+        int64_t nSum = 0;
+        for (const auto nIndex : lookupIndexes)
+        {
+            const auto pValue = findValue(lookupStrings[nIndex]);
+            if (pValue)
+                nSum += *pValue;
+        }
+        const auto elapsed = timedRow.stop(static_cast<double>(lookupIndexes.size()));
+        std::cout << "Find time with " << sDesc << ": " << elapsed << '\n';
+
+        timedRow.record({ toStrC(nKeyCount), toStrC(lookupIndexes.size()), toStrC(nSum), sDesc }, { 7 }, elapsed);
+        return nSum;
+    }
+} // unnamed namespace
+
+// Setup of example 3 in mapPerformanceComparison.md with N = 3: const char* lookups to a tiny map of path-like std::string
+// keys that are known at compile time, comparing bench::StaticPerfectHashMap built with constexpr to std::map,
+// std::unordered_map and MapVector.
+TEST(dfgCont, StaticStringMapWithCharPtrLookup)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t nFindCount = 10000;
+#else
+    const size_t nFindCount = 33333333;
+#endif
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nContainerCount = 6;
+
+    static constexpr std::pair<std::string_view, int> staticItems[] =
+    {
+        { "c:/an/example/path/file0.txt", 0 },
+        { "c:/an/example/path/file1.txt", 1 },
+        { "c:/an/example/path/file2.txt", 2 }
+    };
+    static constexpr auto staticPerfectHashMap = bench::makeStaticPerfectHashMap(staticItems);
+    const size_t nKeyCount = std::size(staticItems);
+    const std::vector<const char*> lookupStrings =
+    {
+        "c:/an/example/path/file5.txt",
+        "c:/an/example/path/file55",
+        "d:/temp",
+        "C:/temp",
+        "c:/an/example/path/file1.txt",
+        "c:/an/example/path/file.txt"
+    };
+
+    BenchmarkResultTable table({ "Key count", "Find count", "Value sum", "Test type" }, nContainerCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    std::map<std::string, int> mStd;
+    std::map<std::string, int, std::less<>> mStdTransparent;
+    std::unordered_map<std::string, int> mStdUnordered;
+    MapVectorSoA<std::string, int> mSoA;
+    MapVectorAoS<std::string, int> mAoS;
+    mAoS.setSorting(false);
+    for (const auto& item : staticItems)
+    {
+        const std::string sKey(item.first);
+        mStd.insert(std::pair<std::string, int>(sKey, item.second));
+        mStdTransparent.insert(std::pair<std::string, int>(sKey, item.second));
+        mStdUnordered.insert(std::pair<std::string, int>(sKey, item.second));
+        mSoA.insert(sKey, item.second);
+        mAoS.insert(sKey, item.second);
+    }
+
+    std::vector<uint8_t> lookupIndexes(nFindCount);
+    {
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(randEngSeed);
+        for (auto& nIndex : lookupIndexes)
+            nIndex = static_cast<uint8_t>(DFG_MODULE_NS(rand)::rand<int>(randEng, 0, static_cast<int>(lookupStrings.size()) - 1));
+    }
+
+    const auto findInMap = [](auto& cont)
+    {
+        return [&cont](const char* psz) -> const int*
+        {
+            const auto iter = cont.find(psz);
+            return (iter != cont.end()) ? &iter->second : nullptr;
+        };
+    };
+
+    for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1)))
+    {
+        table.beginIteration(repetitions.iterationLabel("Time"));
+        const auto nSum = staticKeyFindTester(containerDescription(mStd), nKeyCount, lookupStrings, lookupIndexes, 1, table, findInMap(mStd));
+        EXPECT_EQ(nSum, staticKeyFindTester("std::map<std::string,int,std::less<>>", nKeyCount, lookupStrings, lookupIndexes, 2, table, findInMap(mStdTransparent)));
+        EXPECT_EQ(nSum, staticKeyFindTester(containerDescription(mStdUnordered), nKeyCount, lookupStrings, lookupIndexes, 3, table, findInMap(mStdUnordered)));
+        EXPECT_EQ(nSum, staticKeyFindTester(containerDescription(mSoA), nKeyCount, lookupStrings, lookupIndexes, 4, table, findInMap(mSoA)));
+        EXPECT_EQ(nSum, staticKeyFindTester(containerDescription(mAoS), nKeyCount, lookupStrings, lookupIndexes, 5, table, findInMap(mAoS)));
+        EXPECT_EQ(nSum, staticKeyFindTester("bench::StaticPerfectHashMap<int>", nKeyCount, lookupStrings, lookupIndexes, 6, table, [&](const char* psz)
+        {
+            return staticPerfectHashMap.find(psz);
+        }));
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkStaticStringMapWithCharPtrLookup"));
+}
+
+namespace
+{
+    using StringKeyedItems = std::vector<std::pair<std::string, int>>;
+
+    // Builds container with build(items) and finds every key of lookupKeys with findValue(cont, key), which returns pointer
+    // to mapped value or nullptr. Build results go to row nBuildRow and find results to row nBuildRow + 1.
+    template <class BuildFunc_T, class FindFunc_T>
+    void stringKeyedMapTester(const std::string& sDesc, const StringKeyedItems& items, const std::vector<std::string>& lookupKeys, const size_t nBuildRow, BenchmarkResultTable& resultTable, BuildFunc_T&& build, FindFunc_T&& findValue)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        size_t nCharCount = 0;
+        for (const auto& item : items)
+            nCharCount += item.first.size();
+        const auto sKeyCount = toStrC(items.size());
+        char szAvgKeyLength[32];
+        toStr(static_cast<double>(nCharCount) / static_cast<double>(items.size()), szAvgKeyLength, 3);
+
+        const auto heapBytesBeforeBuild = bench::heapBytesInUse();
+        TimedRow buildRow(resultTable, nBuildRow);
+        auto cont = build(items);
+        const auto buildTime = buildRow.stop(static_cast<double>(items.size()));
+        const auto heapBytesAfterBuild = bench::heapBytesInUse();
+        const auto sRetainedHeapBytes = (heapBytesBeforeBuild && heapBytesAfterBuild) ? toStrC(*heapBytesAfterBuild - *heapBytesBeforeBuild) : std::string();
+        buildRow.record({ sKeyCount, szAvgKeyLength, "build", sRetainedHeapBytes, toStrC(cont.size()), sDesc }, { 9 }, buildTime);
+
+        TimedRow findRow(resultTable, nBuildRow + 1);
+        int64_t nSum = 0;
+        for (const auto& sKey : lookupKeys)
+        {
+            const auto pValue = findValue(cont, sKey);
+            if (pValue)
+                nSum += *pValue;
+        }
+        const auto findTime = findRow.stop(static_cast<double>(lookupKeys.size()));
+        findRow.record({ sKeyCount, szAvgKeyLength, "find", std::string(), toStrC(nSum), sDesc }, { 9 }, findTime);
+        std::cout << sDesc << ": build time " << buildTime << ", find time " << findTime << ", retained heap bytes " << ((sRetainedHeapBytes.empty()) ? "n/a" : sRetainedHeapBytes) << '\n';
+    }
+} // unnamed namespace
+
+// Build time, find time and retained heap of bench::StringPoolFlatMap (all key characters in one arena) compared to std::map and
+// MapVector with std::string keys. Short keys fit to small string buffer of std::string, long keys need a heap allocation
+// per key. Every container is built from the same items in random order; MapVectors are built by sorting item indexes
+// first and inserting in key order, which avoids O(n) inserts. Retained heap bytes are the increase of heap in use from
+// before to after build, i.e. memory held by the built container; transient peak during build is not included. Empty if
+// not available on platform, see common/heapUsage.hpp.
+TEST(dfgCont, StringPoolFlatMapPerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t nKeyCount = 10000;
+    const size_t nFindCount = 10000;
+#else
+    const size_t nKeyCount = 1000000;
+    const size_t nFindCount = 1000000;
+#endif
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nContainerCount = 4;
+    const char* const keyPrefixes[] = { "", "c:/an/example/path/file" }; // Short keys: "0", "1", ...; long keys: "c:/an/example/path/file0.txt", ...
+
+    BenchmarkResultTable table({ "Key count", "Average key length", "Operation", "Retained heap bytes", "Size or value sum", "Test type" }, std::size(keyPrefixes) * nContainerCount * 2);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    const auto sortedOrder = [](const StringKeyedItems& items)
+    {
+        std::vector<size_t> order(items.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return items[a].first < items[b].first; });
+        return order;
+    };
+    const auto buildMapVector = [&](auto cont, const StringKeyedItems& items)
+    {
+        cont.reserve(items.size());
+        for (const auto i : sortedOrder(items))
+            cont.insert(items[i].first, items[i].second);
+        return cont;
+    };
+    const auto findInMap = [](auto& cont, const std::string& sKey) -> const int*
+    {
+        const auto iter = cont.find(sKey);
+        return (iter != cont.end()) ? &iter->second : nullptr;
+    };
+
+    auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+    randEng.seed(randEngSeed);
+    for (size_t nKeyKind = 0; nKeyKind < std::size(keyPrefixes); ++nKeyKind)
+    {
+        const std::string sPrefix = keyPrefixes[nKeyKind];
+        const char* pszSuffix = (sPrefix.empty()) ? "" : ".txt";
+        StringKeyedItems items;
+        items.reserve(nKeyCount);
+        for (size_t i = 0; i < nKeyCount; ++i)
+            items.push_back(std::pair<std::string, int>(sPrefix + std::to_string(i) + pszSuffix, static_cast<int>(i % 1000)));
+        std::shuffle(items.begin(), items.end(), randEng);
+        // Lookup keys are separate copies so that lookups don't read the build input.
+        std::vector<std::string> lookupKeys;
+        lookupKeys.reserve(nFindCount);
+        for (size_t i = 0; i < nFindCount; ++i)
+            lookupKeys.push_back(items[DFG_MODULE_NS(rand)::rand<size_t>(randEng, 0, nKeyCount - 1)].first);
+
+        const auto nFirstRow = 1 + nKeyKind * nContainerCount * 2;
+        for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1, static_cast<uint32>(nFirstRow), static_cast<uint32>(nFirstRow) + static_cast<uint32>(nContainerCount * 2))))
+        {
+            table.beginIteration(repetitions.iterationLabel("Time"));
+
+            stringKeyedMapTester("std::map<std::string,int,std::less<>>", items, lookupKeys, nFirstRow, table, [](const StringKeyedItems& items)
+            {
+                std::map<std::string, int, std::less<>> m;
+                for (const auto& item : items)
+                    m.insert(item);
+                return m;
+            }, findInMap);
+            stringKeyedMapTester(containerDescription(MapVectorSoA<std::string, int>()), items, lookupKeys, nFirstRow + 2, table, [&](const StringKeyedItems& items)
+            {
+                return buildMapVector(MapVectorSoA<std::string, int>(), items);
+            }, findInMap);
+            stringKeyedMapTester(containerDescription(MapVectorAoS<std::string, int>()), items, lookupKeys, nFirstRow + 4, table, [&](const StringKeyedItems& items)
+            {
+                return buildMapVector(MapVectorAoS<std::string, int>(), items);
+            }, findInMap);
+            stringKeyedMapTester("bench::StringPoolFlatMap<int>", items, lookupKeys, nFirstRow + 6, table, [](const StringKeyedItems& items)
+            {
+                return bench::StringPoolFlatMap<int>(items.begin(), items.end());
+            }, [](const bench::StringPoolFlatMap<int>& m, const std::string& sKey) { return m.find(sKey); });
+        }
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkStringPoolFlatMapPerformance"));
+}
+
+namespace
+{
+    // Replay handler for map-like containers with int keys; insertAt records are sequence operations and are ignored.
+    template <class Cont_T>
+    struct MapReplayHandler
+    {
+        void onInsert(const int64_t nKey, const int64_t nValue)     { m_cont.insert(std::pair<int, int>(static_cast<int>(nKey), static_cast<int>(nValue))); }
+        bool onFind(const int64_t nKey) const                       { return m_cont.find(static_cast<int>(nKey)) != m_cont.end(); }
+        void onErase(const int64_t nKey)                            { m_cont.erase(static_cast<int>(nKey)); }
+        void onInsertAt(uint32_t, int64_t, int64_t)                 {}
+
+        void onUpdate(const int64_t nKey, const int64_t nValue)
+        {
+            const auto iter = m_cont.find(static_cast<int>(nKey));
+            if (iter != m_cont.end())
+                iter->second = static_cast<int>(nValue);
+        }
+
+        Cont_T& m_cont;
+    };
+
+    // Replays the whole trace to an empty container of type Cont_T and adds results to row nRow.
+    template <class Cont_T>
+    void traceReplayTester(const std::string& sTraceDesc, const bench::TraceView& trace, const size_t nRow, BenchmarkResultTable& resultTable)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        Cont_T cont;
+        MapReplayHandler<Cont_T> handler{ cont };
+        TimedRow timedRow(resultTable, nRow);
+        const auto nFound = bench::replayTrace(trace, handler);
+        const auto elapsed = timedRow.stop(static_cast<double>(trace.size()));
+        const auto sDesc = containerDescription(cont);
+        std::cout << sDesc << ": replay time " << elapsed << '\n';
+
+        timedRow.record({ sTraceDesc, toStrC(trace.size()), toStrC(nFound), toStrC(cont.size()), sDesc }, { 7, 8 }, elapsed);
+    }
+
+    // Writes synthetic trace used when BENCHMARK_TRACE is not set: nKeyCount random inserts followed by nOpCount operations
+    // of which 80 % are finds, 10 % inserts and 10 % erases of random keys in the same range.
+    void writeSyntheticMapTrace(const std::string& sPath, const size_t nKeyCount, const size_t nOpCount, const unsigned long nRandEngSeed)
+    {
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(nRandEngSeed);
+        const auto nMaxKey = static_cast<int>(2 * nKeyCount);
+        bench::TraceWriter writer(sPath);
+        for (size_t i = 0; i < nKeyCount; ++i)
+        {
+            const auto nKey = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, nMaxKey);
+            writer.write(bench::TraceOp::insert, nKey, nKey);
+        }
+        for (size_t i = 0; i < nOpCount; ++i)
+        {
+            const auto nKey = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, nMaxKey);
+            const auto nOpSelector = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, 9);
+            const auto op = (nOpSelector < 8) ? bench::TraceOp::find : ((nOpSelector == 8) ? bench::TraceOp::insert : bench::TraceOp::erase);
+            writer.write(op, nKey, nKey);
+        }
+        writer.close();
+    }
+
+    // Returns true if sPath can be opened as trace file that has nRecordCount records.
+    bool isTraceWithRecordCount(const std::string& sPath, const size_t nRecordCount)
+    {
+        try
+        {
+            return bench::TraceView(sPath).size() == nRecordCount;
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+    }
+} // unnamed namespace
+
+// Replays a binary operation trace (common/traceFile.hpp) against maps. Trace is read from path in environment variable
+// BENCHMARK_TRACE (see traceConvert/traceConvert.cpp for creating one from text) or, if not set, from a synthetic trace
+// whose file name has the generation parameters; it's generated only if no such file with expected record count exists.
+// Synthetic trace is kept at the scale of the mixed workload test (~26 MB in release build); replaying large traces is
+// opt-in through BENCHMARK_TRACE.
+// Trace is memory-mapped and prefaulted before timing, so timed region has only map operations and reads of the
+// fixed-size records.
+TEST(dfgCont, MapTraceReplayPerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+
+#ifdef _DEBUG
+    const size_t nSyntheticKeyCount = 10000;
+    const size_t nSyntheticOpCount = 100000;
+#else
+    const size_t nSyntheticKeyCount = 100000;
+    const size_t nSyntheticOpCount = 1000000;
+#endif
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nContainerCount = 6;
+
+    std::string sTracePath;
+    if (const char* psz = std::getenv("BENCHMARK_TRACE"))
+        sTracePath = psz;
+    else
+    {
+        const unsigned long nSyntheticSeed = 12345678;
+        sTracePath = dfg::format_fmt("testfiles/generated/syntheticMapTrace_{}_{}_{}.trace", nSyntheticKeyCount, nSyntheticOpCount, nSyntheticSeed);
+        if (!isTraceWithRecordCount(sTracePath, nSyntheticKeyCount + nSyntheticOpCount))
+            writeSyntheticMapTrace(sTracePath, nSyntheticKeyCount, nSyntheticOpCount, nSyntheticSeed);
+    }
+    const bench::TraceView trace(sTracePath);
+    trace.checkOps();
+    trace.prefault();
+    const auto sTraceDesc = sTracePath + " (finds " + toStrC(trace.countOf(bench::TraceOp::find)) + ", inserts "
+        + toStrC(trace.countOf(bench::TraceOp::insert)) + ", erases " + toStrC(trace.countOf(bench::TraceOp::erase)) + ")";
+
+    BenchmarkResultTable table({ "Trace", "Op count", "Found count", "Final size", "Test type" }, nContainerCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1)))
+    {
+        table.beginIteration(repetitions.iterationLabel("Time"));
+        traceReplayTester<std::map<int, int>>(sTraceDesc, trace, 1, table);
+        traceReplayTester<std::unordered_map<int, int>>(sTraceDesc, trace, 2, table);
+        traceReplayTester<boost::container::flat_map<int, int>>(sTraceDesc, trace, 3, table);
+        traceReplayTester<MapVectorSoA<int, int>>(sTraceDesc, trace, 4, table);
+        traceReplayTester<MapVectorAoS<int, int>>(sTraceDesc, trace, 5, table);
+        traceReplayTester<bench::FlatHashMap<int, int>>(sTraceDesc, trace, 6, table);
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapTraceReplayPerformance"));
+}
+
+namespace
+{
+    // Operation mix of mixed workload in percentages, sums to 100.
+    struct WorkloadMix
+    {
+        int nReadPercent;
+        int nInsertPercent;
+        int nUpdatePercent;
+        int nErasePercent;
+    };
+
+    std::string workloadMixDescription(const WorkloadMix& mix)
+    {
+        return DFG_ROOT_NS::format_fmt("read/insert/update/erase {}/{}/{}/{}", mix.nReadPercent, mix.nInsertPercent, mix.nUpdatePercent, mix.nErasePercent);
+    }
+
+    // Returns nOpCount operations with keys uniformly from [0, nMaxKey]; inserts and updates have random values.
+    template <class RandEng_T>
+    std::vector<bench::TraceRecord> generateMixedWorkload(const WorkloadMix& mix, const int nMaxKey, const size_t nOpCount, RandEng_T& randEng)
+    {
+        std::vector<bench::TraceRecord> ops;
+        ops.reserve(nOpCount);
+        for (size_t i = 0; i < nOpCount; ++i)
+        {
+            const auto nSelector = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, 99);
+            const auto nKey = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, nMaxKey);
+            const auto nValue = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, 1000000);
+            bench::TraceOp op = bench::TraceOp::erase;
+            if (nSelector < mix.nReadPercent)
+                op = bench::TraceOp::find;
+            else if (nSelector < mix.nReadPercent + mix.nInsertPercent)
+                op = bench::TraceOp::insert;
+            else if (nSelector < mix.nReadPercent + mix.nInsertPercent + mix.nUpdatePercent)
+                op = bench::TraceOp::update;
+            ops.push_back(bench::TraceRecord{ op, 0, nKey, nValue });
+        }
+        return ops;
+    }
+
+    struct MixedWorkloadResult
+    {
+        size_t nFoundCount = 0;
+        size_t nFinalSize = 0;
+        int64_t nChecksum = 0; // Order-independent checksum of final content.
+    };
+
+    // Pre-populates container of type Cont_T with initialKeys (key == value) and times running ops against it. Time column
+    // gets throughput in million operations per second.
+    template <class Cont_T>
+    MixedWorkloadResult mixedWorkloadTester(const std::vector<int>& initialKeys, const std::vector<bench::TraceRecord>& ops, const std::string& sMixDesc, const size_t nRow, BenchmarkResultTable& resultTable)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        Cont_T cont;
+        MapReplayHandler<Cont_T> handler{ cont };
+        for (const auto nKey : initialKeys)
+            handler.onInsert(nKey, nKey);
+
+        MixedWorkloadResult result;
+        TimedRow timedRow(resultTable, nRow);
+        result.nFoundCount = bench::replayTrace(ops.data(), ops.data() + ops.size(), handler);
+        const auto elapsed = timedRow.stop(static_cast<double>(ops.size()));
+        result.nFinalSize = cont.size();
+        for (const auto& item : cont)
+            result.nChecksum += int64_t(item.first) * 1000003 + item.second;
+        const auto mopsPerSecond = static_cast<double>(ops.size()) / elapsed / 1e6;
+        const auto sDesc = containerDescription(cont);
+        std::cout << sDesc << ", " << sMixDesc << ": " << mopsPerSecond << " Mops/s\n";
+
+        timedRow.record({ toStrC(initialKeys.size()), toStrC(ops.size()), sMixDesc, toStrC(result.nFoundCount), toStrC(result.nFinalSize), toStrC(result.nChecksum), sDesc }, { 8, 9, 10 }, mopsPerSecond);
+        return result;
+    }
+} // unnamed namespace
+
+// YCSB-style mixed workload: every map is pre-populated with the same keys and then runs the same stream of finds, inserts,
+// updates (assign to existing key) and erases with keys uniformly from range where about half of the keys exist. Default
+// mixes are read-mostly 95/5/0/0, update-heavy 50/0/50/0 and churn 80/10/0/10 (read/insert/update/erase percentages);
+// environment variable BENCHMARK_MIX=R/I/U/E replaces them with a single custom mix. Result columns are throughput in Mops/s;
+// found count, final size and content checksum must be equal for all maps.
+TEST(dfgCont, MapMixedWorkloadPerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t nKeyCount = 10000;
+    const size_t nOpCount = 100000;
+#else
+    const size_t nKeyCount = 100000;
+    const size_t nOpCount = 1000000;
+#endif
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nContainerCount = 6;
+
+    std::vector<WorkloadMix> mixes = { { 95, 5, 0, 0 }, { 50, 0, 50, 0 }, { 80, 10, 0, 10 } };
+    if (const char* psz = std::getenv("BENCHMARK_MIX"))
+    {
+        WorkloadMix mix{};
+        const auto nParsed = std::sscanf(psz, "%d/%d/%d/%d", &mix.nReadPercent, &mix.nInsertPercent, &mix.nUpdatePercent, &mix.nErasePercent);
+        const auto bValid = (nParsed == 4 && (std::min)({ mix.nReadPercent, mix.nInsertPercent, mix.nUpdatePercent, mix.nErasePercent }) >= 0
+                             && mix.nReadPercent + mix.nInsertPercent + mix.nUpdatePercent + mix.nErasePercent == 100);
+        ASSERT_TRUE(bValid) << "Invalid BENCHMARK_MIX '" << psz << "', expected R/I/U/E percentages that sum to 100";
+        mixes = { mix };
+    }
+
+    BenchmarkResultTable table({ "Initial size", "Op count", "Mix", "Found count", "Final size", "Content checksum", "Test type" }, mixes.size() * nContainerCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+    randEng.seed(randEngSeed);
+    // Initial keys are sorted so that sorted vector maps are populated by appending.
+    const auto nMaxKey = static_cast<int>(2 * nKeyCount);
+    std::vector<int> initialKeys;
+    initialKeys.reserve(nKeyCount);
+    for (size_t i = 0; i < nKeyCount; ++i)
+        initialKeys.push_back(DFG_MODULE_NS(rand)::rand<int>(randEng, 0, nMaxKey));
+    std::sort(initialKeys.begin(), initialKeys.end());
+    initialKeys.erase(std::unique(initialKeys.begin(), initialKeys.end()), initialKeys.end());
+
+    std::vector<std::vector<bench::TraceRecord>> workloads;
+    for (const auto& mix : mixes)
+        workloads.push_back(generateMixedWorkload(mix, nMaxKey, nOpCount, randEng));
+
+    for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1)))
+    {
+        table.beginIteration(repetitions.iterationLabel("Mops/s"));
+        for (size_t nMix = 0; nMix < mixes.size(); ++nMix)
+        {
+            const auto& ops = workloads[nMix];
+            const auto sMixDesc = workloadMixDescription(mixes[nMix]);
+            const auto nFirstRow = 1 + nMix * nContainerCount;
+            const auto reference = mixedWorkloadTester<std::map<int, int>>(initialKeys, ops, sMixDesc, nFirstRow, table);
+            const auto expectEqualToReference = [&](const MixedWorkloadResult& result)
+            {
+                EXPECT_EQ(reference.nFoundCount, result.nFoundCount);
+                EXPECT_EQ(reference.nFinalSize, result.nFinalSize);
+                EXPECT_EQ(reference.nChecksum, result.nChecksum);
+            };
+            expectEqualToReference(mixedWorkloadTester<std::unordered_map<int, int>>(initialKeys, ops, sMixDesc, nFirstRow + 1, table));
+            expectEqualToReference(mixedWorkloadTester<boost::container::flat_map<int, int>>(initialKeys, ops, sMixDesc, nFirstRow + 2, table));
+            expectEqualToReference(mixedWorkloadTester<MapVectorSoA<int, int>>(initialKeys, ops, sMixDesc, nFirstRow + 3, table));
+            expectEqualToReference(mixedWorkloadTester<MapVectorAoS<int, int>>(initialKeys, ops, sMixDesc, nFirstRow + 4, table));
+            expectEqualToReference(mixedWorkloadTester<bench::FlatHashMap<int, int>>(initialKeys, ops, sMixDesc, nFirstRow + 5, table));
+        }
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapMixedWorkloadPerformance"));
+}
+
+namespace
+{
+    struct EraseResult
+    {
+        size_t nErasedCount = 0;
+        size_t nFinalSize = 0;
+        int64_t nChecksum = 0; // Order-independent checksum of final content.
+    };
+
+    template <class Cont_T>
+    int64_t contentChecksum(const Cont_T& cont)
+    {
+        int64_t nChecksum = 0;
+        for (const auto& item : cont)
+            nChecksum += int64_t(item.first) * 1000003 + item.second;
+        return nChecksum;
+    }
+
+    int64_t contentChecksum(const bench::TombstoneFlatMap<int, int>& cont)
+    {
+        int64_t nChecksum = 0;
+        cont.forEach([&](const int nKey, const int nValue) { nChecksum += int64_t(nKey) * 1000003 + nValue; });
+        return nChecksum;
+    }
+
+    // Builds container with build() (not timed) and times eraseFunc(cont). Results go to row nRow.
+    template <class BuildFunc_T, class EraseFunc_T>
+    EraseResult eraseTester(const std::string& sDesc, const std::string& sPatternDesc, const size_t nEraseOpCount, const size_t nRow, BenchmarkResultTable& resultTable, BuildFunc_T&& build, EraseFunc_T&& eraseFunc)
+    {
+        using namespace DFG_ROOT_NS;
+        using namespace DFG_MODULE_NS(str);
+        auto cont = build();
+        const auto nInitialSize = cont.size();
+
+        TimedRow timedRow(resultTable, nRow);
+        eraseFunc(cont);
+        const auto elapsed = timedRow.stop(static_cast<double>(nEraseOpCount));
+
+        EraseResult result;
+        result.nFinalSize = cont.size();
+        result.nErasedCount = nInitialSize - result.nFinalSize;
+        result.nChecksum = contentChecksum(cont);
+        std::cout << sDesc << ", " << sPatternDesc << ": " << elapsed << '\n';
+
+        timedRow.record({ toStrC(nInitialSize), sPatternDesc, toStrC(nEraseOpCount), toStrC(result.nErasedCount), toStrC(result.nFinalSize), toStrC(result.nChecksum), sDesc }, { 8, 10 }, elapsed);
+        return result;
+    }
+} // unnamed namespace
+
+// Erase performance of all maps from a map of random keys with two patterns: random single-key erases of a quarter of the
+// keys in random order and range erases of key ranges that each cover 0.1 % of the key space (like expiry sweeps). Sorted
+// vector maps shift elements on every erase; bench::TombstoneFlatMap (common/TombstoneFlatMap.hpp) marks slots dead and
+// compacts in batches, its "eager" variant compacts on every erase for comparison. Hash maps erase ranges key by key.
+// Erased count and content checksum must be equal for all maps.
+TEST(dfgCont, MapErasePerformance)
+{
+    using namespace DFG_ROOT_NS;
+    using namespace DFG_MODULE_NS(cont);
+    using namespace DFG_MODULE_NS(str);
+    const int randEngSeed = 12345678;
+
+#ifdef _DEBUG
+    const size_t nKeyCount = 20000;
+#else
+    const size_t nKeyCount = 200000;
+#endif
+    const size_t nRangeCount = 100;
+    const auto repetitionPolicy = bench::repetitionPolicyFromEnvironment();
+    const size_t nContainerCount = 8;
+    const size_t nPatternCount = 2;
+
+    BenchmarkResultTable table({ "Initial size", "Erase pattern", "Erase op count", "Erased count", "Final size", "Content checksum", "Test type" }, nPatternCount * nContainerCount);
+    const auto nLastStaticColumn = table.lastStaticColumn();
+
+    auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+    randEng.seed(randEngSeed);
+    const auto nMaxKey = static_cast<int>(4 * nKeyCount);
+    std::vector<int> keys;
+    keys.reserve(nKeyCount);
+    for (size_t i = 0; i < nKeyCount; ++i)
+        keys.push_back(DFG_MODULE_NS(rand)::rand<int>(randEng, 0, nMaxKey));
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    // Single-key pattern: a quarter of the keys in random order. Range pattern: [first, first + width) ranges.
+    std::vector<int> singleEraseKeys = keys;
+    std::shuffle(singleEraseKeys.begin(), singleEraseKeys.end(), randEng);
+    singleEraseKeys.resize(keys.size() / 4);
+    const int nRangeWidth = (std::max)(1, nMaxKey / 1000);
+    std::vector<int> rangeFirstKeys(nRangeCount);
+    for (auto& nFirst : rangeFirstKeys)
+        nFirst = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, nMaxKey - nRangeWidth);
+
+    using MapSoA = MapVectorSoA<int, int>;
+    using MapAoS = MapVectorAoS<int, int>;
+    using BoostFlatMap = boost::container::flat_map<int, int>;
+    using TombstoneMap = bench::TombstoneFlatMap<int, int>;
+
+    const auto buildBy = [&](auto cont)
+    {
+        return [&, cont]() mutable
+        {
+            for (const auto nKey : keys)
+                cont.insert(std::pair<int, int>(nKey, nKey));
+            return cont;
+        };
+    };
+    const auto buildTombstoneMap = [&](const double maxDeadRatio)
+    {
+        return [&, maxDeadRatio]()
+        {
+            TombstoneMap cont;
+            cont.setMaxDeadRatio(maxDeadRatio);
+            cont.reserve(keys.size());
+            for (const auto nKey : keys)
+                cont.insert(nKey, nKey);
+            return cont;
+        };
+    };
+    const auto buildFlatHashMap = [&]()
+    {
+        bench::FlatHashMap<int, int> cont;
+        cont.reserve(keys.size());
+        for (const auto nKey : keys)
+            cont.insert(std::pair<int, int>(nKey, nKey));
+        return cont;
+    };
+
+    const auto eraseSingleKeys = [&](auto& cont)
+    {
+        for (const auto nKey : singleEraseKeys)
+            cont.erase(nKey);
+    };
+    const auto eraseRangesKeyByKey = [&](auto& cont)
+    {
+        for (const auto nFirst : rangeFirstKeys)
+        {
+            for (int nKey = nFirst; nKey < nFirst + nRangeWidth; ++nKey)
+                cont.erase(nKey);
+        }
+    };
+    const auto eraseRangesByLowerBound = [&](auto& cont)
+    {
+        for (const auto nFirst : rangeFirstKeys)
+            cont.erase(cont.lower_bound(nFirst), cont.lower_bound(nFirst + nRangeWidth));
+    };
+    const auto eraseRangesSoA = [&](MapSoA& cont)
+    {
+        for (const auto nFirst : rangeFirstKeys)
+        {
+            const auto keyRange = cont.keyRange();
+            const auto nBegin = std::lower_bound(keyRange.begin(), keyRange.end(), nFirst) - keyRange.begin();
+            const auto nEnd = std::lower_bound(keyRange.begin(), keyRange.end(), nFirst + nRangeWidth) - keyRange.begin();
+            cont.erase(cont.begin() + nBegin, cont.begin() + nEnd);
+        }
+    };
+    const auto eraseRangesAoS = [&](MapAoS& cont)
+    {
+        const auto keyLess = [](const MapAoS::value_type& item, const int nKey) { return item.first < nKey; };
+        for (const auto nFirst : rangeFirstKeys)
+        {
+            auto& storage = cont.m_storage;
+            const auto iterBegin = std::lower_bound(storage.begin(), storage.end(), nFirst, keyLess);
+            const auto iterEnd = std::lower_bound(iterBegin, storage.end(), nFirst + nRangeWidth, keyLess);
+            storage.erase(iterBegin, iterEnd);
+        }
+    };
+    const auto eraseRangesTombstone = [&](TombstoneMap& cont)
+    {
+        for (const auto nFirst : rangeFirstKeys)
+            cont.eraseRange(nFirst, nFirst + nRangeWidth);
+    };
+
+    const std::string patternDescs[nPatternCount] = { "random single keys", "ranges of width " + toStrC(nRangeWidth) };
+    const size_t eraseOpCounts[nPatternCount] = { singleEraseKeys.size(), nRangeCount };
+    for (bench::RepetitionController repetitions(repetitionPolicy); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1)))
+    {
+        table.beginIteration(repetitions.iterationLabel("Time"));
+        for (size_t nPattern = 0; nPattern < nPatternCount; ++nPattern)
+        {
+            const bool bRanges = (nPattern == 1);
+            const auto& sPattern = patternDescs[nPattern];
+            const auto nOpCount = eraseOpCounts[nPattern];
+            const auto nFirstRow = 1 + nPattern * nContainerCount;
+            const auto reference = eraseTester(containerDescription(std::map<int, int>()), sPattern, nOpCount, nFirstRow, table, buildBy(std::map<int, int>()), [&](std::map<int, int>& cont)
+            {
+                (bRanges) ? eraseRangesByLowerBound(cont) : eraseSingleKeys(cont);
+            });
+            const auto expectEqualToReference = [&](const EraseResult& result)
+            {
+                EXPECT_EQ(reference.nErasedCount, result.nErasedCount);
+                EXPECT_EQ(reference.nFinalSize, result.nFinalSize);
+                EXPECT_EQ(reference.nChecksum, result.nChecksum);
+            };
+            expectEqualToReference(eraseTester(containerDescription(std::unordered_map<int, int>()), sPattern, nOpCount, nFirstRow + 1, table, buildBy(std::unordered_map<int, int>()), [&](std::unordered_map<int, int>& cont)
+            {
+                (bRanges) ? eraseRangesKeyByKey(cont) : eraseSingleKeys(cont);
+            }));
+            expectEqualToReference(eraseTester(containerDescription(BoostFlatMap()), sPattern, nOpCount, nFirstRow + 2, table, buildBy(BoostFlatMap()), [&](BoostFlatMap& cont)
+            {
+                (bRanges) ? eraseRangesByLowerBound(cont) : eraseSingleKeys(cont);
+            }));
+            expectEqualToReference(eraseTester(containerDescription(MapSoA()), sPattern, nOpCount, nFirstRow + 3, table, buildBy(MapSoA()), [&](MapSoA& cont)
+            {
+                (bRanges) ? eraseRangesSoA(cont) : eraseSingleKeys(cont);
+            }));
+            expectEqualToReference(eraseTester(containerDescription(MapAoS()), sPattern, nOpCount, nFirstRow + 4, table, buildBy(MapAoS()), [&](MapAoS& cont)
+            {
+                (bRanges) ? eraseRangesAoS(cont) : eraseSingleKeys(cont);
+            }));
+            expectEqualToReference(eraseTester(containerDescription(bench::FlatHashMap<int, int>()), sPattern, nOpCount, nFirstRow + 5, table, buildFlatHashMap, [&](bench::FlatHashMap<int, int>& cont)
+            {
+                (bRanges) ? eraseRangesKeyByKey(cont) : eraseSingleKeys(cont);
+            }));
+            expectEqualToReference(eraseTester("bench::TombstoneFlatMap<int,int>, max dead ratio 0.25", sPattern, nOpCount, nFirstRow + 6, table, buildTombstoneMap(0.25), [&](TombstoneMap& cont)
+            {
+                (bRanges) ? eraseRangesTombstone(cont) : eraseSingleKeys(cont);
+            }));
+            expectEqualToReference(eraseTester("bench::TombstoneFlatMap<int,int>, eager (max dead ratio 0)", sPattern, nOpCount, nFirstRow + 7, table, buildTombstoneMap(0), [&](TombstoneMap& cont)
+            {
+                (bRanges) ? eraseRangesTombstone(cont) : eraseSingleKeys(cont);
+            }));
+        }
+    }
+
+    table.addReducedValuesAndWriteToFile(nLastStaticColumn + 1, DFG_ASCII("benchmarkMapErasePerformance"));
+}
+
 #endif // on/off switch for performance tests.
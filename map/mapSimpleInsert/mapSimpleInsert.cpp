@@ -1,8 +1,73 @@
+/*
+
+Benchmark for inserting N int->int pairs in order to a map: measures insert time, destroy time and peak memory usage.
+
+All benchmarked maps are registered in RegisteredMaps type list below and the cases to run are chosen with command line filters:
+
+    --map=<id>[,<id>...]    Map id(s) to run, by default all. Ids: map, unordered_map, boost_flat_map, MapVectorSoA, MapVectorAoS,
+                            flat_hash_map (bench::FlatHashMap in common/FlatHashMap.hpp),
+                            pmr_map, pmr_unordered_map (pmr maps only if standard library has <memory_resource>)
+    --reserve=on|off|any    Whether to run reserved and/or not reserved variants (ignored for maps that have no reserve()). Default: any
+    --allocator=<id>[,<id>...]  Memory resource(s) for pmr maps, by default all. Ids: default, pool (unsynchronized_pool_resource),
+                            monotonic (monotonic_buffer_resource), node_pool (FixedSizeNodePoolResource in common/memoryResources.hpp),
+                            arena (ArenaResource: map destructor is skipped and arena is released in one go)
+    --count=<N>             Insert count, accepts scientific notation such as 1e7. Default: 1e7
+    --no-header             Doesn't print CSV header line
+    --list                  Lists cases matching the filters without running them
+    --isolate               Runs each case in a forked child process (POSIX only)
+    --perf-counters         Adds per operation hardware counter columns (cycles, instructions, L1D/LLC/dTLB misses,
+                            branch misses) for timed regions, Linux only; columns are empty if counters are not available.
+    --sweep[=MIN:MAX[:FACTOR]]  Runs every case with geometrically growing element counts, default 256:134217728:2 (i.e. 2^8 - 2^27).
+                            Sweep prints one row per map and count with insert/find ns per operation, destroy ns per element
+                            and heap bytes per element (glibc only), see results_sweep.csv.conf for charting.
+    --hit-ratio=<0..1>      Fraction of sweep finds that target an existing key, misses look up keys outside the map. Default: 1
+    --zipf=<exponent>       Zipf exponent of sweep find keys, 0 (default) means uniform (see common/keyStream.hpp)
+    --working-set=<N>       Number of distinct existing keys that sweep finds hit, 0 (default) means all
+    --trace=<path>          Replays binary operation trace (common/traceFile.hpp, see traceConvert/traceConvert.cpp) to every case
+                            instead of inserting --count keys. Prints one row per case with replay ns per operation, found count,
+                            final size, destroy ns per element and heap bytes per element (glibc only). Trace is memory-mapped
+                            and prefaulted before timing.
+    --latency[=K]           Times every K'th (default 16) insert and sweep find with cycle counter and adds p50, p99, p99.9 and
+                            max latency columns in nanoseconds (see common/latencyHistogram.hpp). Not available with --trace.
+    --repetitions[=W/MIN/MAX/CI/BUDGET]  Runs every case W warmup times without printing and then MIN - MAX times printing a row
+                            per run, stopping when 95 % confidence interval of the median insert (replay) time, and with --sweep
+                            also find time, is within +-CI relative to the median or after BUDGET seconds per case.
+                            Default 1/3/20/0.02/30 (see common/repetitionRunner.hpp). Without the option every case runs once.
+
+Example: mapSimpleInsertCmake --map=MapVectorSoA --reserve=off --count=1e7
+
+Note that peak memory columns are process-wide high-water marks, so without --isolate only the first case in a process reports
+its own peak memory. With --isolate each case gets a fresh process and the child sends its results to parent through a pipe.
+
+*/
+
 #include <iostream>
 #include <map>
 #include <unordered_map>
 #include <random>
 #include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define MAPSIMPLEINSERT_HAS_POSIX 1
+    #include <cerrno>
+    #include <cstring>
+    #include <fstream>
+    #include <sys/resource.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#else
+    #define MAPSIMPLEINSERT_HAS_POSIX 0
+#endif
 
 #include <boost/container/flat_map.hpp>
 
@@ -13,72 +78,894 @@
 #include <dfg/time.hpp>
 #include <dfg/cont/MapVector.hpp>
 
+#include "../../common/commandLine.hpp"
+#include "../../common/FlatHashMap.hpp"
+#include "../../common/heapUsage.hpp"
+#include "../../common/keyStream.hpp"
+#include "../../common/latencyHistogram.hpp"
+#include "../../common/mapBenchmarkTypes.hpp"
+#include "../../common/traceFile.hpp"
+#include "../../common/memoryResources.hpp"
+#include "../../common/perfCounters.hpp"
+#include "../../common/repetitionRunner.hpp"
+
 template <class K, class V> using MapVectorSoA = dfg::cont::MapVectorSoA<K, V>;
 template <class K, class V> using MapVectorAoS = dfg::cont::MapVectorAoS<K, V>;
 
 std::mt19937 randEng(static_cast<unsigned int>(1234));
 
-template <class T> std::string prettyTypeName()								   { return typeid(T).name(); }
-template <> std::string prettyTypeName<std::map<int, int>>()                   { return "std::map<int,int>"; }
-template <> std::string prettyTypeName<std::unordered_map<int, int>>()         { return "std::unordered_map<int, int>"; }
-template <> std::string prettyTypeName<boost::container::flat_map<int, int>>() { return "boost::flat_map<int, int>"; }
-template <> std::string prettyTypeName<MapVectorSoA<int, int>>()               { return "MapVectorSoA<int, int>"; }
-template <> std::string prettyTypeName<MapVectorAoS<int, int>>()               { return "MapVectorAoS<int, int>"; }
+// Names and --map ids of maps that are not in common/mapBenchmarkTypes.hpp.
+namespace bench
+{
+    template <> std::string prettyTypeName<FlatHashMap<int, int>>()                { return "bench::FlatHashMap<int, int>"; }
+    template <> std::string mapId<FlatHashMap<int, int>>()                         { return "flat_hash_map"; }
+#if BENCH_HAS_PMR
+    template <> std::string prettyTypeName<std::pmr::map<int, int>>()              { return "std::pmr::map<int,int>"; }
+    template <> std::string prettyTypeName<std::pmr::unordered_map<int, int>>()    { return "std::pmr::unordered_map<int, int>"; }
+    template <> std::string mapId<std::pmr::map<int, int>>()                       { return "pmr_map"; }
+    template <> std::string mapId<std::pmr::unordered_map<int, int>>()             { return "pmr_unordered_map"; }
+#endif
+}
+
+struct InsertPair
+{
+    template <class Map_T> void operator()(Map_T& m, int a, int b) const { m.insert(std::pair(a, b)); }
+};
+
+struct InsertKeyAndValue
+{
+    template <class Map_T> void operator()(Map_T& m, int a, int b) const { m.insert(a, b); }
+};
+
+template <class Map_T, class Inserter_T>
+struct MapRegistration
+{
+    using MapType = Map_T;
+    using Inserter = Inserter_T;
+};
+
+// List of all benchmarked maps. Reserved and not reserved variants are generated automatically for maps that have reserve()
+// and variants for every bench::AllocatorKind for pmr maps.
+using RegisteredMaps = bench::TypeList<
+    MapRegistration<std::map<int, int>,                   InsertPair>,
+    MapRegistration<std::unordered_map<int, int>,         InsertPair>,
+    MapRegistration<boost::container::flat_map<int, int>, InsertPair>,
+    MapRegistration<MapVectorSoA<int, int>,               InsertKeyAndValue>,
+    MapRegistration<MapVectorAoS<int, int>,               InsertKeyAndValue>,
+    MapRegistration<bench::FlatHashMap<int, int>,         InsertPair>
+#if BENCH_HAS_PMR
+    , MapRegistration<std::pmr::map<int, int>,            InsertPair>
+    , MapRegistration<std::pmr::unordered_map<int, int>,  InsertPair>
+#endif
+>;
+
+template <class Map_T>
+constexpr bool hasReserve() { return requires(Map_T& m) { m.reserve(size_t(1)); }; }
+
+template <class Map_T>
+constexpr bool isPmrMap()
+{
+#if BENCH_HAS_PMR
+    return bench::usesPolymorphicAllocator<Map_T>();
+#else
+    return false;
+#endif
+}
+
+// Parameters of a single benchmark case.
+struct CaseParams
+{
+    bool bReserve = true;
+    int nInsertCount = 10000000; // 1e7
+    int nFindCount = 0; // If non-zero, timing find() calls with keys from keyStream before destroying the map.
+    bench::KeyStreamParams keyStream;
+    bool bPerfCounters = false; // If true, collecting hardware performance counters for timed regions.
+    const bench::TraceView* pTrace = nullptr; // If not null, replaying this trace instead of inserting nInsertCount keys.
+    size_t nLatencySampleInterval = 0; // If non-zero, timing every nLatencySampleInterval'th insert and find.
+    bench::AllocatorKind allocatorKind = bench::AllocatorKind::defaultResource; // Used only with pmr maps.
+};
+
+template <class Map_T>
+std::string caseDescription(const CaseParams& params)
+{
+    std::string s = bench::prettyTypeName<Map_T>();
+    if constexpr (isPmrMap<Map_T>())
+        s += std::string(" (") + bench::allocatorKindDescription(params.allocatorKind) + ")";
+    if (params.bReserve == false)
+        s += " (not reserved)";
+    return s;
+}
+
+// Results of a single case. Trivially copyable so that it can be sent as raw bytes from isolated child process.
+struct CaseResult
+{
+    double insertSeconds = 0;
+    int nRandomElement = 0;
+    double destroySeconds = 0;
+    double totalSeconds = 0;
+    bool bHasPeakWorkingSet = false;
+    std::uint64_t nPeakWorkingSet = 0;
+    bool bHasPeakVm = false;
+    std::uint64_t nPeakVm = 0;
+    bool bHasPageFaults = false;
+    std::int64_t nMinorPageFaults = 0;
+    std::int64_t nMajorPageFaults = 0;
+    double findSeconds = 0;
+    std::int64_t nFoundCount = 0;
+    bool bHasHeapBytes = false;
+    std::int64_t nHeapBytes = 0; // Heap bytes in use by the map after inserts, includes allocator bookkeeping.
+    std::int64_t nFinalSize = 0; // Map size after trace replay.
+    bench::PerfCounterValues insertCounters;
+    bench::PerfCounterValues findCounters;
+    bench::PerfCounterValues destroyCounters;
+    bench::LatencyPercentiles insertLatency;
+    bench::LatencyPercentiles findLatency;
+};
+
+static_assert(std::is_trivially_copyable_v<CaseResult>);
+
+struct PageFaultCounts
+{
+    std::int64_t nMinor = 0;
+    std::int64_t nMajor = 0;
+};
+
+std::optional<PageFaultCounts> pageFaultCounts()
+{
+#if MAPSIMPLEINSERT_HAS_POSIX
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return std::nullopt;
+    return PageFaultCounts{ usage.ru_minflt, usage.ru_majflt };
+#else
+    return std::nullopt;
+#endif
+}
 
-template <class Map_T, bool Reserve_T = true, class Inserter_T>
-void testMap(Inserter_T inserter)
+template <class Map_T, class Inserter_T>
+CaseResult testMap(Inserter_T inserter, const CaseParams& params)
 {
     using Timer = dfg::time::TimerCpu;
-    const char cDelim = ';';
-    std::cout << dfg::time::localDate_yyyy_mm_dd_hh_mm_ss_C() << cDelim;
-    //std::cout << std::chrono::utc_clock().now() << cDelim; // Not available in GCC 11.3.0
-    std::cout << prettyTypeName<Map_T>() << ((Reserve_T == false) ? " (not reserved)" : "") << cDelim;
+    CaseResult result;
+    const auto faultsAtStart = pageFaultCounts();
+    // Generating find keys before timers so that random generation is not included in find time. Map has keys
+    // [0, nInsertCount), so misses are taken from [nInsertCount, 2 * nInsertCount] (capped to int range).
+    const auto nMissKeyMax = static_cast<int>((std::min)(2 * static_cast<std::int64_t>(params.nInsertCount), static_cast<std::int64_t>((std::numeric_limits<int>::max)())));
+    std::uniform_int_distribution<> missKeyDistr(params.nInsertCount, nMissKeyMax);
+    const auto findKeys = bench::generateKeyStream<int>(static_cast<size_t>(params.nInsertCount), static_cast<size_t>(params.nFindCount), params.keyStream, randEng,
+                                                        [](const size_t i) { return static_cast<int>(i); },
+                                                        [&](auto& re) { return missKeyDistr(re); });
+    bench::LatencySampler insertLatencySampler(params.nLatencySampleInterval);
+    bench::LatencySampler findLatencySampler(params.nLatencySampleInterval);
+    const auto heapBytesAtStart = bench::heapBytesInUse();
+    bench::PerfCounters perfCounters(params.bPerfCounters);
     Timer timerTotal;
     {
         Timer timerDestroy;
         {
+#if BENCH_HAS_PMR
+            // Memory resource of pmr map is owned together with the map so that releasing it is within destroy timing.
+            bench::ResourceBackedContainer<Map_T> mapHolder(params.allocatorKind);
+            Map_T& m = mapHolder.get();
+#else
             Map_T m;
+#endif
+            perfCounters.start(); // Counters are started before and stopped after timer so that their overhead is not in timings.
             Timer timerInsert;
-            const int nInsertCount = 10000000; // 1e7
+            const int nInsertCount = params.nInsertCount;
             // If map-type has reserve, using it.
-            if constexpr (Reserve_T && requires { m.reserve(nInsertCount); })
-                m.reserve(nInsertCount);
-            for (int i = 0; i < nInsertCount; ++i)
-                inserter(m, i, i);
-            std::cout << timerInsert.elapsedWallSeconds() << cDelim;
+            if constexpr (hasReserve<Map_T>())
+            {
+                if (params.bReserve)
+                    m.reserve(nInsertCount);
+            }
+            if (insertLatencySampler.enabled())
+            {
+                for (int i = 0; i < nInsertCount; ++i)
+                    insertLatencySampler.measure([&] { inserter(m, i, i); });
+            }
+            else
+            {
+                for (int i = 0; i < nInsertCount; ++i)
+                    inserter(m, i, i);
+            }
+            result.insertSeconds = timerInsert.elapsedWallSeconds();
+            result.insertCounters = perfCounters.stop();
+            result.insertLatency = insertLatencySampler.percentiles();
+            const auto heapBytesAfterInsert = bench::heapBytesInUse();
+            if (heapBytesAtStart && heapBytesAfterInsert)
+            {
+                result.bHasHeapBytes = true;
+                result.nHeapBytes = *heapBytesAfterInsert - *heapBytesAtStart;
+            }
+            if (!findKeys.empty())
+            {
+                perfCounters.start();
+                Timer timerFind;
+                std::int64_t nFound = 0;
+                if (findLatencySampler.enabled())
+                {
+                    for (const auto key : findKeys)
+                        nFound += findLatencySampler.measure([&] { return m.find(key) != m.end(); });
+                }
+                else
+                {
+                    for (const auto key : findKeys)
+                        nFound += (m.find(key) != m.end());
+                }
+                result.findSeconds = timerFind.elapsedWallSeconds();
+                result.findCounters = perfCounters.stop();
+                result.findLatency = findLatencySampler.percentiles();
+                result.nFoundCount = nFound;
+            }
             // Accessing random element in map to prevent optimizer from thinking nothing uses the data.
             {
                 const auto nTest = std::uniform_int_distribution<>(0, nInsertCount - 1)(randEng);
-                std::cout << m[nTest] << cDelim;
+                result.nRandomElement = m[nTest];
             }
+            perfCounters.start();
             timerDestroy = Timer();
         }
-        std::cout << timerDestroy.elapsedWallSeconds() << cDelim;
+        result.destroySeconds = timerDestroy.elapsedWallSeconds();
+        result.destroyCounters = perfCounters.stop();
     }
-    std::cout << timerTotal.elapsedWallSeconds() << cDelim;
+    result.totalSeconds = timerTotal.elapsedWallSeconds();
     const auto memInfo = ::DFG_MODULE_NS(os)::getMemoryUsage_process();
     const auto peakWorkingSet = memInfo.workingSetPeakSize();
     const auto peakVm = memInfo.virtualMemoryPeak();
-    if (peakWorkingSet.has_value())
-        std::cout << ::DFG_MODULE_NS(str)::ByteCountFormatter_metric(*peakWorkingSet);
+    result.bHasPeakWorkingSet = peakWorkingSet.has_value();
+    result.nPeakWorkingSet = peakWorkingSet.value_or(0);
+    result.bHasPeakVm = peakVm.has_value();
+    result.nPeakVm = peakVm.value_or(0);
+    const auto faultsAtEnd = pageFaultCounts();
+    if (faultsAtStart && faultsAtEnd)
+    {
+        result.bHasPageFaults = true;
+        result.nMinorPageFaults = faultsAtEnd->nMinor - faultsAtStart->nMinor;
+        result.nMajorPageFaults = faultsAtEnd->nMajor - faultsAtStart->nMajor;
+    }
+    return result;
+}
+
+// Trace replay handler that inserts with the inserter of map registration.
+template <class Map_T, class Inserter_T>
+struct TraceReplayHandler
+{
+    void onInsert(const std::int64_t nKey, const std::int64_t nValue)  { m_inserter(m_map, static_cast<int>(nKey), static_cast<int>(nValue)); }
+    bool onFind(const std::int64_t nKey) const                         { return m_map.find(static_cast<int>(nKey)) != m_map.end(); }
+    void onErase(const std::int64_t nKey)                              { m_map.erase(static_cast<int>(nKey)); }
+    void onInsertAt(std::uint32_t, std::int64_t, std::int64_t)         {} // Sequence operation, not applicable to maps.
+
+    void onUpdate(const std::int64_t nKey, const std::int64_t nValue)
+    {
+        const auto iter = m_map.find(static_cast<int>(nKey));
+        if (iter != m_map.end())
+            iter->second = static_cast<int>(nValue);
+    }
+
+    Map_T& m_map;
+    Inserter_T m_inserter;
+};
+
+// Like testMap(), but timed insert region replays *params.pTrace. Reserved variant reserves for the number of insert records.
+template <class Map_T, class Inserter_T>
+CaseResult testMapTrace(Inserter_T inserter, const CaseParams& params)
+{
+    using Timer = dfg::time::TimerCpu;
+    CaseResult result;
+    const auto& trace = *params.pTrace;
+    const auto nReserveCount = (params.bReserve) ? trace.countOf(bench::TraceOp::insert) : size_t(0);
+    const auto heapBytesAtStart = bench::heapBytesInUse();
+    bench::PerfCounters perfCounters(params.bPerfCounters);
+    Timer timerTotal;
+    {
+        Timer timerDestroy;
+        {
+#if BENCH_HAS_PMR
+            bench::ResourceBackedContainer<Map_T> mapHolder(params.allocatorKind);
+            Map_T& m = mapHolder.get();
+#else
+            Map_T m;
+#endif
+            TraceReplayHandler<Map_T, Inserter_T> handler{ m, inserter };
+            perfCounters.start();
+            Timer timerReplay;
+            if constexpr (hasReserve<Map_T>())
+            {
+                if (nReserveCount > 0)
+                    m.reserve(nReserveCount);
+            }
+            result.nFoundCount = static_cast<std::int64_t>(bench::replayTrace(trace, handler));
+            result.insertSeconds = timerReplay.elapsedWallSeconds();
+            result.insertCounters = perfCounters.stop();
+            result.nFinalSize = static_cast<std::int64_t>(m.size());
+            const auto heapBytesAfterReplay = bench::heapBytesInUse();
+            if (heapBytesAtStart && heapBytesAfterReplay)
+            {
+                result.bHasHeapBytes = true;
+                result.nHeapBytes = *heapBytesAfterReplay - *heapBytesAtStart;
+            }
+            perfCounters.start();
+            timerDestroy = Timer();
+        }
+        result.destroySeconds = timerDestroy.elapsedWallSeconds();
+        result.destroyCounters = perfCounters.stop();
+    }
+    result.totalSeconds = timerTotal.elapsedWallSeconds();
+    return result;
+}
+
+// Prints header columns for per operation counters of a timed region, e.g. ";Insert cycles/op".
+void printPerfCounterHeader(const char* pszRegion)
+{
+    for (size_t i = 0; i < bench::perfCounterCount; ++i)
+        std::cout << ';' << pszRegion << ' ' << bench::perfCounterColumnName(static_cast<bench::PerfCounterId>(i));
+}
+
+void printPerfCounterValues(const bench::PerfCounterValues& values, const int nOpCount)
+{
+    for (size_t i = 0; i < bench::perfCounterCount; ++i)
+    {
+        const auto id = static_cast<bench::PerfCounterId>(i);
+        std::cout << ';';
+        if (values.isAvailable(id))
+            std::cout << values.perOperation(id, nOpCount);
+    }
+}
+
+// Prints header columns for latency percentiles of a timed region, e.g. ";Insert p50 ns".
+void printLatencyHeader(const char* pszRegion)
+{
+    for (const char* pszColumn : { "p50", "p99", "p99.9", "max" })
+        std::cout << ';' << pszRegion << ' ' << pszColumn << " ns";
+}
+
+void printLatencyValues(const bench::LatencyPercentiles& percentiles)
+{
+    std::cout << ';' << percentiles.p50 << ';' << percentiles.p99 << ';' << percentiles.p999 << ';' << percentiles.max;
+}
+
+void printCaseRow(const std::string& sRunTime, const std::string& sCaseDescription, const CaseParams& params, const CaseResult& result)
+{
+    const char cDelim = ';';
+    std::cout << sRunTime << cDelim;
+    //std::cout << std::chrono::utc_clock().now() << cDelim; // Not available in GCC 11.3.0
+    std::cout << sCaseDescription << cDelim;
+    std::cout << result.insertSeconds << cDelim;
+    std::cout << result.nRandomElement << cDelim;
+    std::cout << result.destroySeconds << cDelim;
+    std::cout << result.totalSeconds << cDelim;
+    if (result.bHasPeakWorkingSet)
+        std::cout << ::DFG_MODULE_NS(str)::ByteCountFormatter_metric(result.nPeakWorkingSet);
     std::cout << cDelim;
-    if (peakVm.has_value())
-        std::cout << ::DFG_MODULE_NS(str)::ByteCountFormatter_metric(*peakVm);
+    if (result.bHasPeakVm)
+        std::cout << ::DFG_MODULE_NS(str)::ByteCountFormatter_metric(result.nPeakVm);
     std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_compilerAndShortVersion>();
     std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_cppStandardVersion>();
     std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_buildDebugReleaseType>();
     std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_standardLibrary>();
     std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_boostVersion>();
+    std::cout << cDelim;
+    if (result.bHasPageFaults)
+        std::cout << result.nMinorPageFaults;
+    std::cout << cDelim;
+    if (result.bHasPageFaults)
+        std::cout << result.nMajorPageFaults;
+    if (params.bPerfCounters)
+    {
+        printPerfCounterValues(result.insertCounters, params.nInsertCount);
+        printPerfCounterValues(result.destroyCounters, params.nInsertCount);
+    }
+    if (params.nLatencySampleInterval != 0)
+        printLatencyValues(result.insertLatency);
+    std::cout << '\n';
+}
+
+// Prints a row of sweep output: one row per map and element count with per operation figures.
+void printSweepRow(const std::string& sRunTime, const std::string& sCaseDescription, const CaseParams& params, const CaseResult& result)
+{
+    const char cDelim = ';';
+    const auto nanosecondsPer = [](const double seconds, const int nCount) { return (nCount > 0) ? 1e9 * seconds / nCount : 0.0; };
+    std::cout << sRunTime << cDelim;
+    std::cout << sCaseDescription << cDelim;
+    std::cout << params.nInsertCount << cDelim;
+    std::cout << nanosecondsPer(result.insertSeconds, params.nInsertCount) << cDelim;
+    std::cout << nanosecondsPer(result.findSeconds, params.nFindCount) << cDelim;
+    std::cout << nanosecondsPer(result.destroySeconds, params.nInsertCount) << cDelim;
+    if (result.bHasHeapBytes)
+        std::cout << static_cast<double>(result.nHeapBytes) / params.nInsertCount;
+    std::cout << cDelim << result.nFoundCount;
+    std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_compilerAndShortVersion>();
+    std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_standardLibrary>();
+    if (params.bPerfCounters)
+    {
+        printPerfCounterValues(result.insertCounters, params.nInsertCount);
+        printPerfCounterValues(result.findCounters, params.nFindCount);
+        printPerfCounterValues(result.destroyCounters, params.nInsertCount);
+    }
+    if (params.nLatencySampleInterval != 0)
+    {
+        printLatencyValues(result.insertLatency);
+        printLatencyValues(result.findLatency);
+    }
+    std::cout << '\n';
+}
+
+// Prints a row of trace replay output: one row per map with per operation figures.
+void printTraceRow(const std::string& sRunTime, const std::string& sCaseDescription, const CaseParams& params, const CaseResult& result)
+{
+    const char cDelim = ';';
+    const auto nOpCount = static_cast<int>((std::min)(params.pTrace->size(), static_cast<size_t>((std::numeric_limits<int>::max)())));
+    const auto nFinalSize = static_cast<int>(result.nFinalSize);
+    const auto nanosecondsPer = [](const double seconds, const int nCount) { return (nCount > 0) ? 1e9 * seconds / nCount : 0.0; };
+    std::cout << sRunTime << cDelim;
+    std::cout << sCaseDescription << cDelim;
+    std::cout << params.pTrace->size() << cDelim;
+    std::cout << nanosecondsPer(result.insertSeconds, nOpCount) << cDelim;
+    std::cout << result.nFoundCount << cDelim;
+    std::cout << result.nFinalSize << cDelim;
+    std::cout << nanosecondsPer(result.destroySeconds, nFinalSize) << cDelim;
+    if (result.bHasHeapBytes && nFinalSize > 0)
+        std::cout << static_cast<double>(result.nHeapBytes) / nFinalSize;
+    std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_compilerAndShortVersion>();
+    std::cout << cDelim << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_standardLibrary>();
+    if (params.bPerfCounters)
+    {
+        printPerfCounterValues(result.insertCounters, nOpCount);
+        printPerfCounterValues(result.destroyCounters, nFinalSize);
+    }
     std::cout << '\n';
 }
 
-int main()
+#if MAPSIMPLEINSERT_HAS_POSIX
+
+// Runs caseFunc in a forked child process and returns the CaseResult it sent through a pipe, empty if child failed.
+// This gives each case a fresh process so that peak memory figures are not polluted by earlier cases.
+template <class CaseFunc_T>
+std::optional<CaseResult> runInChildProcess(CaseFunc_T&& caseFunc)
 {
-    std::cout << "Run time;Map type;Insert duration;Random element;Delete duration;Total duration;Peak memory working set;Peak virtual memory usage;Compiler;C++ standard version;Build type;Standard library;Boost version\n";
-    testMap<std::map<int, int>>([](auto& m, auto a, auto b) { m.insert(std::pair(a, b)); });
-    //testMap<std::unordered_map<int, int>>([](auto& m, auto a, auto b) { m.insert(std::pair(a, b)); });
-    //testMap<std::unordered_map<int, int>, false>([](auto& m, auto a, auto b) { m.insert(std::pair(a, b)); });
-    //testMap<boost::container::flat_map<int, int>>([](auto& m, auto a, auto b) { m.insert(std::pair(a, b)); });
-    //testMap<MapVectorSoA<int, int>>([](auto& m, auto a, auto b) { m.insert(a, b); });
-    //testMap<MapVectorAoS<int, int>>([](auto& m, auto a, auto b) { m.insert(a, b); });
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0)
+    {
+        std::cerr << "pipe() failed: " << std::strerror(errno) << '\n';
+        return std::nullopt;
+    }
+    std::cout.flush(); // Flushing so that child doesn't inherit and re-output pending buffer content.
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "fork() failed: " << std::strerror(errno) << '\n';
+        close(pipeFds[0]);
+        close(pipeFds[1]);
+        return std::nullopt;
+    }
+    if (pid == 0) // Case: child
+    {
+        close(pipeFds[0]);
+        // Resetting peak resident set size inherited from parent (supported since Linux 4.0, failure is ignored).
+        {
+            std::ofstream clearRefs("/proc/self/clear_refs");
+            clearRefs << "5";
+        }
+        const CaseResult result = caseFunc();
+        const char* p = reinterpret_cast<const char*>(&result);
+        size_t nRemaining = sizeof(result);
+        while (nRemaining > 0)
+        {
+            const auto nWritten = write(pipeFds[1], p, nRemaining);
+            if (nWritten <= 0)
+                _exit(2);
+            p += nWritten;
+            nRemaining -= static_cast<size_t>(nWritten);
+        }
+        close(pipeFds[1]);
+        _exit(0);
+    }
+
+    // Case: parent
+    close(pipeFds[1]);
+    CaseResult result;
+    char* p = reinterpret_cast<char*>(&result);
+    size_t nReceived = 0;
+    while (nReceived < sizeof(result))
+    {
+        const auto nRead = read(pipeFds[0], p + nReceived, sizeof(result) - nReceived);
+        if (nRead < 0 && errno == EINTR)
+            continue;
+        if (nRead <= 0)
+            break;
+        nReceived += static_cast<size_t>(nRead);
+    }
+    close(pipeFds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    if (nReceived != sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "Child process failed to produce result";
+        if (WIFSIGNALED(status))
+            std::cerr << " (terminated by signal " << WTERMSIG(status) << ")";
+        std::cerr << '\n';
+        return std::nullopt;
+    }
+    return result;
+}
+
+#endif // MAPSIMPLEINSERT_HAS_POSIX
+
+enum class ReserveFilter { on, off, any };
+
+struct Options
+{
+    std::vector<std::string> mapIds; // Empty means all.
+    std::vector<std::string> allocatorIds; // Empty means all.
+    ReserveFilter reserveFilter = ReserveFilter::any;
+    int nInsertCount = CaseParams().nInsertCount;
+    bool bPrintHeader = true;
+    bool bListOnly = false;
+    bool bIsolate = false;
+    bool bPerfCounters = false;
+    std::vector<int> sweepCounts; // If not empty, running sweep over these element counts instead of single nInsertCount.
+    bench::KeyStreamParams keyStreamParams;
+    std::string sTracePath; // If not empty, replaying this trace instead of inserts.
+    size_t nLatencySampleInterval = 0;
+    bench::RepetitionPolicy repetitionPolicy = { 0, 1, 1, 0, 0 }; // Single run unless --repetitions is given.
+};
+
+// Parses sweep specification MIN:MAX[:FACTOR] to list of geometrically growing element counts, MAX is always included.
+std::optional<std::vector<int>> parseSweep(const std::string& s)
+{
+    std::vector<std::string> parts;
+    {
+        std::string_view sv = (s.empty()) ? std::string_view("256:134217728") : std::string_view(s); // Default is 2^8 - 2^27
+        while (true)
+        {
+            const auto nPos = sv.find(':');
+            parts.emplace_back(sv.substr(0, nPos));
+            if (nPos == std::string_view::npos)
+                break;
+            sv.remove_prefix(nPos + 1);
+        }
+    }
+    if (parts.size() != 2 && parts.size() != 3)
+        return std::nullopt;
+    const auto nMin = bench::parseCount(parts[0]);
+    const auto nMax = bench::parseCount(parts[1]);
+    char* pEnd = nullptr;
+    const double factor = (parts.size() == 3) ? std::strtod(parts[2].c_str(), &pEnd) : 2.0;
+    if (!nMin || !nMax || *nMin > *nMax || (pEnd && *pEnd != '\0') || !(factor > 1))
+        return std::nullopt;
+    std::vector<int> counts;
+    for (double val = *nMin; val < *nMax; val *= factor)
+    {
+        const auto nCount = static_cast<int>(std::llround(val));
+        if (counts.empty() || counts.back() != nCount)
+            counts.push_back(nCount);
+    }
+    counts.push_back(*nMax);
+    return counts;
+}
+
+// Returns --map ids of registered maps in registration order.
+template <class... Registrations_T>
+std::vector<std::string> registeredMapIds(bench::TypeList<Registrations_T...>)
+{
+    return { bench::mapId<typename Registrations_T::MapType>()... };
+}
+
+// Returns empty on invalid command line, in which case error message has already been printed.
+std::optional<Options> parseCommandLine(const int argc, const char* const* argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view sArg = argv[i];
+        const auto [sName, sValue] = bench::splitCommandLineArg(sArg);
+        if (sName == "--map")
+        {
+            options.mapIds = bench::splitByComma(sValue);
+            const auto validIds = registeredMapIds(RegisteredMaps());
+            for (const auto& sId : options.mapIds)
+            {
+                if (std::find(validIds.begin(), validIds.end(), sId) == validIds.end())
+                {
+                    std::cerr << "Invalid --map value '" << sId << "', expected one of:";
+                    for (const auto& sValidId : validIds)
+                        std::cerr << ' ' << sValidId;
+                    std::cerr << '\n';
+                    return std::nullopt;
+                }
+            }
+        }
+        else if (sName == "--allocator")
+        {
+            options.allocatorIds = bench::splitByComma(sValue);
+            for (const auto& sId : options.allocatorIds)
+            {
+                if (std::none_of(std::begin(bench::allAllocatorKinds), std::end(bench::allAllocatorKinds), [&](const auto kind) { return sId == bench::allocatorKindId(kind); }))
+                {
+                    std::cerr << "Invalid --allocator value '" << sId << "', expected default, pool, monotonic, node_pool or arena\n";
+                    return std::nullopt;
+                }
+            }
+        }
+        else if (sName == "--reserve")
+        {
+            if (sValue == "on")
+                options.reserveFilter = ReserveFilter::on;
+            else if (sValue == "off")
+                options.reserveFilter = ReserveFilter::off;
+            else if (sValue == "any")
+                options.reserveFilter = ReserveFilter::any;
+            else
+            {
+                std::cerr << "Invalid --reserve value '" << sValue << "', expected on, off or any\n";
+                return std::nullopt;
+            }
+        }
+        else if (sName == "--count")
+        {
+            const auto nCount = bench::parseCount(sValue);
+            if (!nCount)
+            {
+                std::cerr << "Invalid --count value '" << sValue << "'\n";
+                return std::nullopt;
+            }
+            options.nInsertCount = *nCount;
+        }
+        else if (sName == "--sweep")
+        {
+            auto counts = parseSweep(sValue);
+            if (!counts)
+            {
+                std::cerr << "Invalid --sweep value '" << sValue << "', expected MIN:MAX[:FACTOR]\n";
+                return std::nullopt;
+            }
+            options.sweepCounts = std::move(*counts);
+        }
+        else if (sName == "--latency")
+        {
+            const auto nInterval = (sValue.empty()) ? std::optional<int>(16) : bench::parseCount(sValue);
+            if (!nInterval)
+            {
+                std::cerr << "Invalid --latency value '" << sValue << "'\n";
+                return std::nullopt;
+            }
+            options.nLatencySampleInterval = static_cast<size_t>(*nInterval);
+        }
+        else if (sName == "--repetitions")
+        {
+            const auto policy = (sValue.empty()) ? std::optional<bench::RepetitionPolicy>(bench::RepetitionPolicy()) : bench::parseRepetitionPolicy(sValue);
+            if (!policy)
+            {
+                std::cerr << "Invalid --repetitions value '" << sValue << "', expected W/MIN/MAX/CI/BUDGET with 1 <= MIN <= MAX\n";
+                return std::nullopt;
+            }
+            options.repetitionPolicy = *policy;
+        }
+        else if (sName == "--trace")
+        {
+            if (sValue.empty())
+            {
+                std::cerr << "Missing --trace path\n";
+                return std::nullopt;
+            }
+            options.sTracePath = sValue;
+        }
+        else if (bench::isKeyStreamOption(sName))
+        {
+            if (!bench::applyKeyStreamOption(options.keyStreamParams, sName, sValue))
+            {
+                std::cerr << "Invalid " << sName << " value '" << sValue << "'\n";
+                return std::nullopt;
+            }
+        }
+        else if (sArg == "--no-header")
+            options.bPrintHeader = false;
+        else if (sArg == "--list")
+            options.bListOnly = true;
+        else if (sArg == "--perf-counters")
+            options.bPerfCounters = true;
+        else if (sArg == "--isolate")
+        {
+#if MAPSIMPLEINSERT_HAS_POSIX
+            options.bIsolate = true;
+#else
+            std::cerr << "--isolate is not supported on this platform\n";
+            return std::nullopt;
+#endif
+        }
+        else
+        {
+            std::cerr << "Unknown argument '" << sArg << "'\n";
+            return std::nullopt;
+        }
+    }
+    if (!options.sTracePath.empty() && !options.sweepCounts.empty())
+    {
+        std::cerr << "--trace and --sweep can't be used together\n";
+        return std::nullopt;
+    }
+    if (!options.sTracePath.empty() && options.nLatencySampleInterval != 0)
+    {
+        std::cerr << "--trace and --latency can't be used together\n";
+        return std::nullopt;
+    }
+    return options;
+}
+
+bool isMapSelected(const Options& options, const std::string& sId)
+{
+    return options.mapIds.empty() || std::find(options.mapIds.begin(), options.mapIds.end(), sId) != options.mapIds.end();
+}
+
+// Calls func.template operator()<Registration>(CaseParams) for every registered case that passes filters in options.
+template <class Func_T, class... Registrations_T>
+void forEachCase(const Options& options, bench::TypeList<Registrations_T...>, Func_T&& func)
+{
+    const auto handleRegistration = [&](auto registration)
+    {
+        using Registration = decltype(registration);
+        using Map = typename Registration::MapType;
+        if (!isMapSelected(options, bench::mapId<Map>()))
+            return;
+        const auto handleCounts = [&](CaseParams params)
+        {
+            params.bPerfCounters = options.bPerfCounters;
+            params.keyStream = options.keyStreamParams;
+            params.nLatencySampleInterval = options.nLatencySampleInterval;
+            if (options.sweepCounts.empty())
+            {
+                params.nInsertCount = options.nInsertCount;
+                func.template operator()<Registration>(params);
+                return;
+            }
+            for (const auto nCount : options.sweepCounts)
+            {
+                params.nInsertCount = nCount;
+                params.nFindCount = std::clamp(nCount, 1 << 20, 1 << 24);
+                func.template operator()<Registration>(params);
+            }
+        };
+        const auto handleAllocators = [&](CaseParams params)
+        {
+            if constexpr (isPmrMap<Map>())
+            {
+                for (const auto kind : bench::allAllocatorKinds)
+                {
+                    const auto& ids = options.allocatorIds;
+                    if (ids.empty() || std::find(ids.begin(), ids.end(), bench::allocatorKindId(kind)) != ids.end())
+                    {
+                        params.allocatorKind = kind;
+                        handleCounts(params);
+                    }
+                }
+            }
+            else // Case: allocator is not applicable so running regardless of allocator filter.
+                handleCounts(params);
+        };
+        if constexpr (hasReserve<Map>())
+        {
+            for (const bool bReserve : { true, false })
+            {
+                if (options.reserveFilter == ReserveFilter::any || bReserve == (options.reserveFilter == ReserveFilter::on))
+                {
+                    CaseParams params;
+                    params.bReserve = bReserve;
+                    handleAllocators(params);
+                }
+            }
+        }
+        else // Case: reserve is not applicable so running regardless of reserve filter.
+            handleAllocators(CaseParams());
+    };
+    (handleRegistration(Registrations_T()), ...);
+}
+
+int main(int argc, char* argv[])
+{
+    const auto options = parseCommandLine(argc, argv);
+    if (!options)
+        return 1;
+
+    if (options->bListOnly)
+    {
+        forEachCase(*options, RegisteredMaps(), []<class Registration_T>(const CaseParams& params)
+        {
+            std::cout << caseDescription<typename Registration_T::MapType>(params) << ", count " << params.nInsertCount << '\n';
+        });
+        return 0;
+    }
+
+    if (options->bPerfCounters && !bench::PerfCounters().anyAvailable())
+        std::cerr << "Note: hardware performance counters are not available, counter columns will be empty\n";
+
+    // Trace is mapped and its pages touched before any case so that neither is part of timed regions.
+    std::optional<bench::TraceView> trace;
+    if (!options->sTracePath.empty())
+    {
+        try
+        {
+            trace.emplace(options->sTracePath);
+            trace->checkOps();
+            trace->prefault();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Unable to use trace: " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    const bool bSweep = !options->sweepCounts.empty();
+    if (options->bPrintHeader)
+    {
+        if (trace)
+            std::cout << "Run time;Map type;Trace op count;Replay ns/op;Found count;Final size;Destroy ns/element;Bytes/element;Compiler;Standard library";
+        else if (bSweep)
+            std::cout << "Run time;Map type;Element count;Insert ns/op;Find ns/op;Destroy ns/element;Bytes/element;Found count;Compiler;Standard library";
+        else
+            std::cout << "Run time;Map type;Insert duration;Random element;Delete duration;Total duration;Peak memory working set;Peak virtual memory usage;Compiler;C++ standard version;Build type;Standard library;Boost version;Minor page faults;Major page faults";
+        if (options->bPerfCounters)
+        {
+            printPerfCounterHeader((trace) ? "Replay" : "Insert");
+            if (bSweep)
+                printPerfCounterHeader("Find");
+            printPerfCounterHeader("Delete");
+        }
+        if (options->nLatencySampleInterval != 0)
+        {
+            printLatencyHeader("Insert");
+            if (bSweep)
+                printLatencyHeader("Find");
+        }
+        std::cout << '\n';
+    }
+    forEachCase(*options, RegisteredMaps(), [&]<class Registration_T>(CaseParams params)
+    {
+        using Map = typename Registration_T::MapType;
+        const auto sRunTime = dfg::time::localDate_yyyy_mm_dd_hh_mm_ss_C();
+        params.pTrace = (trace) ? &*trace : nullptr;
+        const auto runCase = [&]()
+        {
+            return (params.pTrace) ? testMapTrace<Map>(typename Registration_T::Inserter(), params) : testMap<Map>(typename Registration_T::Inserter(), params);
+        };
+        const auto printRow = [&](const CaseResult& result)
+        {
+            if (params.pTrace)
+                printTraceRow(sRunTime, caseDescription<Map>(params), params, result);
+            else if (bSweep)
+                printSweepRow(sRunTime, caseDescription<Map>(params), params, result);
+            else
+                printCaseRow(sRunTime, caseDescription<Map>(params), params, result);
+        };
+        const auto runOnce = [&]() -> std::optional<CaseResult>
+        {
+#if MAPSIMPLEINSERT_HAS_POSIX
+            if (options->bIsolate)
+                return runInChildProcess(runCase);
+#endif
+            return runCase();
+        };
+        std::vector<double> insertSeconds;
+        std::vector<double> findSeconds;
+        const auto maxRelativeCi = [&]()
+        {
+            return (std::max)(bench::summarizeSamples(insertSeconds).relativeCiHalfWidth(), bench::summarizeSamples(findSeconds).relativeCiHalfWidth());
+        };
+        for (bench::RepetitionController repetitions(options->repetitionPolicy); !repetitions.done(); repetitions.advance(maxRelativeCi()))
+        {
+            const auto result = runOnce();
+            if (!result)
+            {
+                std::cerr << "Case '" << caseDescription<Map>(params) << "' failed\n";
+                return;
+            }
+            if (repetitions.isWarmup())
+                continue;
+            printRow(*result);
+            insertSeconds.push_back(result->insertSeconds);
+            if (bSweep)
+                findSeconds.push_back(result->findSeconds);
+        }
+    });
 }
@@ -1,20 +1,6 @@
-for i in $(seq 1 5);
-do
-    ./mapSimpleInsertCmake_map_gcc_libstdcpp; sleep 1
-    ./mapSimpleInsertCmake_map_clang_libcpp; sleep 1
-
-    ./mapSimpleInsertCmake_unordered_map_reserved_gcc_libstdcpp; sleep 1
-    ./mapSimpleInsertCmake_unordered_map_reserved_clang_libcpp; sleep 1
-
-    ./mapSimpleInsertCmake_unordered_map_notreserved_gcc_libstdcpp; sleep 1
-    ./mapSimpleInsertCmake_unordered_map_notreserved_clang_libcpp; sleep 1
-
-    ./mapSimpleInsertCmake_boost_flat_map_gcc_libstdcpp; sleep 1
-    ./mapSimpleInsertCmake_boost_flat_map_clang_libcpp; sleep 1
-
-    ./mapSimpleInsertCmake_MapVectorSoA_gcc_libstdcpp; sleep 1
-    ./mapSimpleInsertCmake_MapVectorSoA_clang_libcpp; sleep 1
-    
-    ./mapSimpleInsertCmake_MapVectorAoS_gcc_libstdcpp; sleep 1
-    ./mapSimpleInsertCmake_MapVectorAoS_clang_libcpp; sleep 1
-done
+# Runs the full case matrix with each case in a separate child process since peak memory figures are process-wide.
+# Every case is repeated until its median insert time has converged or its time budget is used (--repetitions, see
+# mapSimpleInsert.cpp), so the number of rows per case varies; warmup runs are not printed.
+# Expects binaries built from the same mapSimpleInsertCmake target with GCC/libstdc++ and Clang/libc++.
+./mapSimpleInsertCmake_gcc_libstdcpp --no-header --isolate --repetitions; sleep 1
+./mapSimpleInsertCmake_clang_libcpp --no-header --isolate --repetitions
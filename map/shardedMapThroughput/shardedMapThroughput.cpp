@@ -0,0 +1,377 @@
+/*
+
+Multi-threaded throughput benchmark for maps sharded by key hash.
+
+N worker threads run a mix of insert and find operations against a map that is split to N shards, each shard being
+one of the benchmarked map types guarded by its own lock. Keys are generated like in the insert benchmark of
+dfgTestContMapVectorPerformance.cpp (random int in range [-10000000, 10000000]) and inserted as pair (key, key).
+Each shard is pre-populated before timing and operation streams are generated before worker threads are released,
+so timed region only has map and lock operations.
+
+Thread counts go from 1 to hardware thread count in powers of two (hardware thread count itself is always included).
+Output is a semicolon-delimited CSV row per (map, lock, thread count) with aggregate Mops/s and scaling efficiency,
+which is throughput divided by (thread count * single thread throughput).
+
+Options:
+    --map=<id>[,<id>...]            Map id(s) to run, by default all. Ids: map, unordered_map, boost_flat_map, MapVectorSoA, MapVectorAoS
+    --lock=<id>[,<id>...]|any       Shard lock type(s), default any. Ids: mutex, shared_mutex. With shared_mutex finds take
+                                    shared lock.
+    --ops=<N>                       Operation count per thread, default 1e6
+    --initial=<N>                   Total pre-populated key count (split among shards), default 50000
+    --read-percent=<P>              Percentage of find operations, default 90
+    --max-threads=<N>               Maximum thread count, default std::thread::hardware_concurrency()
+    --no-header                     Doesn't print CSV header line
+
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/container/flat_map.hpp>
+
+#include <dfg/build/buildTimeDetails.hpp>
+#include <dfg/cont/MapVector.hpp>
+#include <dfg/rand.hpp>
+#include <dfg/time/timerCpu.hpp>
+
+#include "../../common/commandLine.hpp"
+#include "../../common/mapBenchmarkTypes.hpp"
+
+template <class K, class V> using MapVectorSoA = dfg::cont::MapVectorSoA<K, V>;
+template <class K, class V> using MapVectorAoS = dfg::cont::MapVectorAoS<K, V>;
+
+namespace bench
+{
+    template <> std::string prettyTypeName<std::mutex>()        { return "std::mutex"; }
+    template <> std::string prettyTypeName<std::shared_mutex>() { return "std::shared_mutex"; }
+}
+
+using RegisteredMaps = bench::TypeList<
+    std::map<int, int>,
+    std::unordered_map<int, int>,
+    boost::container::flat_map<int, int>,
+    MapVectorSoA<int, int>,
+    MapVectorAoS<int, int>
+>;
+
+template <class Cont_T>
+void insertImpl(Cont_T& cont, const int key)
+{
+    cont.insert(std::pair<int, int>(key, key));
+}
+
+// Map split to shards by key hash, each shard guarded by its own Mutex_T. If Mutex_T is std::shared_mutex, find() takes shared lock.
+template <class Map_T, class Mutex_T>
+class ShardedMap
+{
+public:
+    explicit ShardedMap(const size_t nShardCount)
+        : m_spShards(std::make_unique<Shard[]>(nShardCount))
+        , m_nShardCount(nShardCount)
+    {}
+
+    void insert(const int key)
+    {
+        auto& shard = shardFor(key);
+        std::unique_lock<Mutex_T> lock(shard.m_mutex);
+        insertImpl(shard.m_map, key);
+    }
+
+    bool contains(const int key)
+    {
+        auto& shard = shardFor(key);
+        if constexpr (std::is_same_v<Mutex_T, std::shared_mutex>)
+        {
+            std::shared_lock<Mutex_T> lock(shard.m_mutex);
+            return shard.m_map.find(key) != shard.m_map.end();
+        }
+        else
+        {
+            std::unique_lock<Mutex_T> lock(shard.m_mutex);
+            return shard.m_map.find(key) != shard.m_map.end();
+        }
+    }
+
+    size_t size() const
+    {
+        size_t nSize = 0;
+        for (size_t i = 0; i < m_nShardCount; ++i)
+            nSize += m_spShards[i].m_map.size();
+        return nSize;
+    }
+
+private:
+    // Aligned to cache line to avoid false sharing between locks of adjacent shards.
+    struct alignas(64) Shard
+    {
+        Mutex_T m_mutex;
+        Map_T m_map;
+    };
+
+    Shard& shardFor(const int key)
+    {
+        // Multiplicative hashing so that shard selection doesn't depend on quality of std::hash<int> (identity in many implementations).
+        const auto nHash = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(key)) * 0x9E3779B97F4A7C15ull) >> 32;
+        return m_spShards[nHash % m_nShardCount];
+    }
+
+    std::unique_ptr<Shard[]> m_spShards;
+    size_t m_nShardCount;
+}; // class ShardedMap
+
+struct Operation
+{
+    int key;
+    bool bFind;
+};
+
+struct Options
+{
+    std::vector<std::string> mapIds; // Empty means all.
+    std::vector<std::string> lockIds; // Empty means all.
+    int nOpsPerThread = 1000000;
+    int nInitialCount = 50000;
+    int nReadPercent = 90;
+    int nMaxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    bool bPrintHeader = true;
+};
+
+struct RunResult
+{
+    double seconds = 0;
+    std::uint64_t nFoundCount = 0;
+    size_t nFinalSize = 0;
+};
+
+template <class Map_T, class Mutex_T>
+RunResult runSharded(const Options& options, const int nThreadCount)
+{
+    const unsigned long nRandEngSeed = 12345678;
+    ShardedMap<Map_T, Mutex_T> shardedMap(static_cast<size_t>(nThreadCount));
+    {
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(nRandEngSeed);
+        for (int i = 0; i < options.nInitialCount; ++i)
+            shardedMap.insert(bench::generateKey(randEng));
+    }
+
+    std::vector<std::vector<Operation>> opsPerThread(static_cast<size_t>(nThreadCount));
+    for (int t = 0; t < nThreadCount; ++t)
+    {
+        auto randEng = DFG_MODULE_NS(rand)::createDefaultRandEngineUnseeded();
+        randEng.seed(nRandEngSeed + 1 + static_cast<unsigned long>(t));
+        auto& ops = opsPerThread[static_cast<size_t>(t)];
+        ops.resize(static_cast<size_t>(options.nOpsPerThread));
+        for (auto& op : ops)
+        {
+            op.key = bench::generateKey(randEng);
+            op.bFind = DFG_MODULE_NS(rand)::rand<int>(randEng, 0, 99) < options.nReadPercent;
+        }
+    }
+
+    std::atomic<int> nReadyCount{ 0 };
+    std::atomic<bool> bGo{ false };
+    std::atomic<std::uint64_t> nTotalFound{ 0 };
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(nThreadCount));
+    for (int t = 0; t < nThreadCount; ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            const auto& ops = opsPerThread[static_cast<size_t>(t)];
+            nReadyCount.fetch_add(1);
+            while (!bGo.load(std::memory_order_acquire))
+                std::this_thread::yield();
+            std::uint64_t nFound = 0;
+            for (const auto& op : ops)
+            {
+                if (op.bFind)
+                    nFound += shardedMap.contains(op.key);
+                else
+                    shardedMap.insert(op.key);
+            }
+            nTotalFound.fetch_add(nFound);
+        });
+    }
+    while (nReadyCount.load() != nThreadCount)
+        std::this_thread::yield();
+
+    dfg::time::TimerCpu timer;
+    bGo.store(true, std::memory_order_release);
+    for (auto& thread : threads)
+        thread.join();
+    RunResult result;
+    result.seconds = timer.elapsedWallSeconds();
+    result.nFoundCount = nTotalFound.load();
+    result.nFinalSize = shardedMap.size();
+    return result;
+}
+
+std::vector<int> threadCounts(const int nMaxThreads)
+{
+    std::vector<int> counts;
+    for (int n = 1; n < nMaxThreads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(nMaxThreads);
+    return counts;
+}
+
+template <class Map_T, class Mutex_T>
+void runScaling(const Options& options)
+{
+    const char cDelim = ';';
+    double singleThreadThroughput = 0;
+    for (const auto nThreadCount : threadCounts(options.nMaxThreads))
+    {
+        const auto result = runSharded<Map_T, Mutex_T>(options, nThreadCount);
+        const double nTotalOps = static_cast<double>(options.nOpsPerThread) * nThreadCount;
+        const double throughput = (result.seconds > 0) ? nTotalOps / result.seconds : 0;
+        if (nThreadCount == 1)
+            singleThreadThroughput = throughput;
+        const double efficiency = (singleThreadThroughput > 0) ? throughput / (nThreadCount * singleThreadThroughput) : 0;
+        std::cout << bench::prettyTypeName<Map_T>() << cDelim
+                  << bench::prettyTypeName<Mutex_T>() << cDelim
+                  << nThreadCount << cDelim
+                  << options.nReadPercent << cDelim
+                  << static_cast<std::uint64_t>(nTotalOps) << cDelim
+                  << result.seconds << cDelim
+                  << throughput / 1e6 << cDelim
+                  << efficiency << cDelim
+                  << result.nFoundCount << cDelim
+                  << result.nFinalSize << cDelim
+                  << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_compilerAndShortVersion>() << cDelim
+                  << dfg::getBuildTimeDetailStr<dfg::BuildTimeDetail_standardLibrary>() << '\n';
+    }
+}
+
+bool isSelected(const std::vector<std::string>& ids, const std::string& sId)
+{
+    return ids.empty() || std::find(ids.begin(), ids.end(), sId) != ids.end();
+}
+
+template <class... Maps_T>
+void runAll(const Options& options, bench::TypeList<Maps_T...>)
+{
+    const auto handleMap = [&](auto* pMap)
+    {
+        using Map = std::remove_pointer_t<decltype(pMap)>;
+        if (!isSelected(options.mapIds, bench::mapId<Map>()))
+            return;
+        if (isSelected(options.lockIds, "mutex"))
+            runScaling<Map, std::mutex>(options);
+        if (isSelected(options.lockIds, "shared_mutex"))
+            runScaling<Map, std::shared_mutex>(options);
+    };
+    (handleMap(static_cast<Maps_T*>(nullptr)), ...);
+}
+
+template <class... Maps_T>
+std::vector<std::string> registeredMapIds(bench::TypeList<Maps_T...>)
+{
+    return { bench::mapId<Maps_T>()... };
+}
+
+// Returns true if all ids are in validIds, otherwise prints error that lists valid ids.
+bool checkIds(const std::string_view sOptionName, const std::vector<std::string>& ids, const std::vector<std::string>& validIds)
+{
+    for (const auto& sId : ids)
+    {
+        if (std::find(validIds.begin(), validIds.end(), sId) != validIds.end())
+            continue;
+        std::cerr << "Invalid " << sOptionName << " value '" << sId << "', expected one of:";
+        for (const auto& sValidId : validIds)
+            std::cerr << ' ' << sValidId;
+        std::cerr << '\n';
+        return false;
+    }
+    return true;
+}
+
+// Returns empty on invalid command line, in which case error message has already been printed.
+std::optional<Options> parseCommandLine(const int argc, const char* const* argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view sArg = argv[i];
+        const auto [sName, sValue] = bench::splitCommandLineArg(sArg);
+        const auto parseCountTo = [&](int& nDest)
+        {
+            const auto nVal = bench::parseCount(sValue);
+            if (nVal)
+                nDest = *nVal;
+            else
+                std::cerr << "Invalid " << sName << " value '" << sValue << "'\n";
+            return nVal.has_value();
+        };
+        if (sName == "--map")
+        {
+            options.mapIds = bench::splitByComma(sValue);
+            if (!checkIds(sName, options.mapIds, registeredMapIds(RegisteredMaps())))
+                return std::nullopt;
+        }
+        else if (sName == "--lock")
+        {
+            options.lockIds = (sValue == "any") ? std::vector<std::string>() : bench::splitByComma(sValue);
+            if (!checkIds(sName, options.lockIds, { "mutex", "shared_mutex" }))
+                return std::nullopt;
+        }
+        else if (sName == "--ops")
+        {
+            if (!parseCountTo(options.nOpsPerThread))
+                return std::nullopt;
+        }
+        else if (sName == "--initial")
+        {
+            if (!parseCountTo(options.nInitialCount))
+                return std::nullopt;
+        }
+        else if (sName == "--max-threads")
+        {
+            if (!parseCountTo(options.nMaxThreads))
+                return std::nullopt;
+        }
+        else if (sName == "--read-percent")
+        {
+            const auto nVal = (sValue == "0") ? std::optional<int>(0) : bench::parseCount(sValue);
+            if (!nVal || *nVal > 100)
+            {
+                std::cerr << "Invalid --read-percent value '" << sValue << "', expected integer in range [0, 100]\n";
+                return std::nullopt;
+            }
+            options.nReadPercent = *nVal;
+        }
+        else if (sArg == "--no-header")
+            options.bPrintHeader = false;
+        else
+        {
+            std::cerr << "Unknown argument '" << sArg << "'\n";
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+int main(int argc, char* argv[])
+{
+    const auto options = parseCommandLine(argc, argv);
+    if (!options)
+        return 1;
+    if (options->bPrintHeader)
+        std::cout << "Map type;Lock type;Threads;Read percent;Total ops;Duration;Mops/s;Scaling efficiency;Found count;Final size;Compiler;Standard library\n";
+    runAll(*options, RegisteredMaps());
+}
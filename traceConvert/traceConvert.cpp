@@ -0,0 +1,150 @@
+/*
+
+Converts text workload files to binary trace files of common/traceFile.hpp, which benchmarks replay from memory mapping
+without parsing in timed region.
+
+Options:
+    --from-indexes=<path>   Input is an insert position file like vectorInsert/vectorInsertIndexes_50000.txt: one
+                            whitespace-separated position per item. Output has an insertAt record per position with
+                            key and value being the item index.
+    --from-text=<path>      Input is a text trace with one operation per line: "insert <key> [<value>]", "find <key>",
+                            "erase <key>", "update <key> <value>" or "insertAt <position> [<value>]". Value defaults
+                            to key (insertAt: 0).
+                            Empty lines and lines starting with '#' are ignored; other lines with non-numeric key or
+                            value or with trailing content are errors. On error no output file is left behind.
+    --out=<path>            Output trace file, required with --from-indexes and --from-text.
+    --info=<path>           Prints record count per operation of a trace file.
+
+Example: traceConvertCmake --from-indexes=vectorInsertIndexes_50000.txt --out=vectorInsertIndexes_50000.trace
+
+*/
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "../common/commandLine.hpp"
+#include "../common/traceFile.hpp"
+
+namespace
+{
+
+size_t convertIndexFile(const std::string& sInput, bench::TraceWriter& writer)
+{
+    std::ifstream istrm(sInput);
+    if (!istrm)
+        throw std::runtime_error("Unable to open '" + sInput + "'");
+    int64_t nPos = 0;
+    int64_t i = 0;
+    while (istrm >> nPos)
+    {
+        if (nPos < 0 || nPos > (std::numeric_limits<uint32_t>::max)())
+            throw std::runtime_error("Position out of range at item " + std::to_string(i));
+        writer.write(bench::TraceOp::insertAt, i, i, static_cast<uint32_t>(nPos));
+        ++i;
+    }
+    if (!istrm.eof())
+        throw std::runtime_error("Invalid position at item " + std::to_string(i));
+    return writer.recordCount();
+}
+
+size_t convertTextTrace(const std::string& sInput, bench::TraceWriter& writer)
+{
+    std::ifstream istrm(sInput);
+    if (!istrm)
+        throw std::runtime_error("Unable to open '" + sInput + "'");
+    std::string sLine;
+    for (size_t nLine = 1; std::getline(istrm, sLine); ++nLine)
+    {
+        std::istringstream lineStrm(sLine);
+        std::string sOp;
+        if (!(lineStrm >> sOp) || sOp[0] == '#')
+            continue;
+        int64_t nKey = 0;
+        if (!(lineStrm >> nKey))
+            throw std::runtime_error("Missing key at line " + std::to_string(nLine));
+        int64_t nValue = 0;
+        const bool bHasValue = static_cast<bool>(lineStrm >> nValue);
+        if (!bHasValue && !lineStrm.eof())
+            throw std::runtime_error("Invalid value at line " + std::to_string(nLine));
+        if (bHasValue && !(lineStrm >> std::ws).eof())
+            throw std::runtime_error("Unexpected trailing content at line " + std::to_string(nLine));
+        if (sOp == "insert")
+            writer.write(bench::TraceOp::insert, nKey, (bHasValue) ? nValue : nKey);
+        else if (sOp == "find" && !bHasValue)
+            writer.write(bench::TraceOp::find, nKey);
+        else if (sOp == "erase" && !bHasValue)
+            writer.write(bench::TraceOp::erase, nKey);
+        else if (sOp == "update" && bHasValue)
+            writer.write(bench::TraceOp::update, nKey, nValue);
+        else if (sOp == "insertAt" && nKey >= 0 && nKey <= (std::numeric_limits<uint32_t>::max)())
+            writer.write(bench::TraceOp::insertAt, 0, nValue, static_cast<uint32_t>(nKey));
+        else
+            throw std::runtime_error("Invalid operation at line " + std::to_string(nLine));
+    }
+    return writer.recordCount();
+}
+
+void printInfo(const std::string& sPath)
+{
+    const bench::TraceView trace(sPath);
+    std::cout << sPath << ": " << trace.size() << " records\n";
+    for (const auto op : { bench::TraceOp::insert, bench::TraceOp::find, bench::TraceOp::erase, bench::TraceOp::insertAt, bench::TraceOp::update })
+        std::cout << "    " << bench::traceOpName(op) << ": " << trace.countOf(op) << '\n';
+}
+
+} // unnamed namespace
+
+int main(int argc, char* argv[])
+{
+    std::string sFromIndexes;
+    std::string sFromText;
+    std::string sOut;
+    std::string sInfo;
+    for (int i = 1; i < argc; ++i)
+    {
+        const auto arg = bench::splitCommandLineArg(argv[i]);
+        if (arg.name == "--from-indexes")
+            sFromIndexes = arg.value;
+        else if (arg.name == "--from-text")
+            sFromText = arg.value;
+        else if (arg.name == "--out")
+            sOut = arg.value;
+        else if (arg.name == "--info")
+            sInfo = arg.value;
+        else
+        {
+            std::cerr << "Unknown option '" << argv[i] << "'\n";
+            return 1;
+        }
+    }
+
+    const bool bConvert = !sFromIndexes.empty() || !sFromText.empty();
+    if ((!bConvert && sInfo.empty()) || (!sFromIndexes.empty() && !sFromText.empty()) || (bConvert && sOut.empty()))
+    {
+        std::cerr << "Usage: traceConvertCmake (--from-indexes=<path>|--from-text=<path>) --out=<path> | --info=<path>\n";
+        return 1;
+    }
+
+    try
+    {
+        if (bConvert)
+        {
+            bench::TraceWriter writer(sOut);
+            const auto nCount = (!sFromIndexes.empty()) ? convertIndexFile(sFromIndexes, writer) : convertTextTrace(sFromText, writer);
+            writer.close();
+            std::cout << "Wrote " << nCount << " records to " << sOut << '\n';
+        }
+        if (!sInfo.empty())
+            printInfo(sInfo);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
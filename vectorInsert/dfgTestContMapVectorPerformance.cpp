@@ -27,12 +27,20 @@ DFG_ROOT_NS_BEGIN{ DFG_SUB_NS(TypeTraits)
 #include <dfg/rand.hpp>
 #include <dfg/str/format_fmt.hpp>
 #include <dfg/time/timerCpu.hpp>
+#include <cstring>
 #include <map>
+#include <optional>
 #include <type_traits>
 #include <unordered_map>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/vector.hpp>
 
+#include "../common/perfCounters.hpp"
+#include "../common/RelocatingVector.hpp"
+#include "../common/repetitionRunner.hpp"
+#include "../common/TieredVector.hpp"
+#include "../common/traceFile.hpp"
+
 namespace
 {
 
@@ -76,6 +84,18 @@ std::string containerDescription(const DFG_MODULE_NS(cont)::Vector<Val_T>&)
 template <class Val_T> std::string containerDescription(const std::vector<Val_T>&) { return "std::vector<" + typeToName<Val_T>::name() + ">"; }
 template <class Val_T> std::string containerDescription(const boost::container::vector<Val_T>&) { return "boost::vector<" + typeToName<Val_T>::name() + ">"; }
 
+template <class Val_T>
+std::string containerDescription(const bench::RelocatingVector<Val_T>&)
+{
+    return DFG_ROOT_NS::format_fmt("bench::RelocatingVector<{}> (trivially relocatable: {})", typeToName<Val_T>::name(), int(bench::isTriviallyRelocatable<Val_T>));
+}
+
+template <class Val_T, size_t BlockSize_T>
+std::string containerDescription(const bench::TieredVector<Val_T, BlockSize_T>&)
+{
+    return DFG_ROOT_NS::format_fmt("bench::TieredVector<{}> (block size {})", typeToName<Val_T>::name(), BlockSize_T);
+}
+
 namespace
 {
     class BenchmarkResultTable : public DFG_MODULE_NS(cont)::TableCsv<char, DFG_ROOT_NS::uint32>
@@ -94,29 +114,103 @@ namespace
             this->addString(DFG_ASCII("avg"),       0, nColCount);
             this->addString(DFG_ASCII("median"),    0, nColCount + 1);
             this->addString(DFG_ASCII("sum"),       0, nColCount + 2);
+            this->addString(DFG_ASCII("min"),       0, nColCount + 3);
+            this->addString(DFG_ASCII("MAD"),       0, nColCount + 4);
+            this->addString(DFG_ASCII("median CI95 low"),   0, nColCount + 5);
+            this->addString(DFG_ASCII("median CI95 high"),  0, nColCount + 6);
+            this->addString(DFG_ASCII("sample count"),      0, nColCount + 7);
             
             DFG_MODULE_NS(cont)::ValueVector<double> vals;
             for (uint32 r = 1; r < nRowCount; ++r)
             {
-                vals.clear();
-                for (uint32 c = firstResultCol; c < nColCount; ++c)
-                {
-                    auto p = (*this)(r, c);
-                    if (!p)
-                        continue;
-                    vals.push_back(DFG_MODULE_NS(str)::strTo<double>(p.rawPtr()));
-                }
+                measuredValues(r, firstResultCol, nColCount, vals);
+                if (vals.empty())
+                    continue;
 
                 const auto avg = vals.average();
                 const auto median = vals.median();
                 const auto sum = vals.sum();
+                const auto summary = bench::summarizeSamples(std::vector<double>(vals.begin(), vals.end()));
 
                 char sz[32];
                 this->addString(SzPtrUtf8(toStr(avg, sz, 6)), r, nColCount);
                 this->addString(SzPtrUtf8(toStr(median, sz, 6)), r, nColCount + 1);
                 this->addString(SzPtrUtf8(toStr(sum, sz, 6)), r, nColCount + 2);
+                this->addString(SzPtrUtf8(toStr(summary.min, sz, 6)), r, nColCount + 3);
+                this->addString(SzPtrUtf8(toStr(summary.mad, sz, 6)), r, nColCount + 4);
+                this->addString(SzPtrUtf8(toStr(summary.ciLow, sz, 6)), r, nColCount + 5);
+                this->addString(SzPtrUtf8(toStr(summary.ciHigh, sz, 6)), r, nColCount + 6);
+                this->addString(SzPtrUtf8(toStrC(summary.nCount).c_str()), r, nColCount + 7);
             }
         }
+
+        // Returns the largest bench::SampleSummary::relativeCiHalfWidth() of measured values over all rows.
+        double maxRelativeCiHalfWidth(const uint32 firstResultCol)
+        {
+            const auto nRowCount = this->rowCountByMaxRowIndex();
+            const auto nColCount = this->colCountByMaxColIndex();
+            DFG_MODULE_NS(cont)::ValueVector<double> vals;
+            double maxCi = 0;
+            for (uint32 r = 1; r < nRowCount; ++r)
+            {
+                measuredValues(r, firstResultCol, nColCount, vals);
+                maxCi = (std::max)(maxCi, bench::summarizeSamples(std::vector<double>(vals.begin(), vals.end())).relativeCiHalfWidth());
+            }
+            return maxCi;
+        }
+
+        // If hardware counter capture is requested with environment variable BENCHMARK_PERF_COUNTERS=1, adds per operation
+        // counter columns starting from nFirstColumn. Returns the number of columns added.
+        uint32 addPerfCounterColumns(const uint32 nFirstColumn)
+        {
+            using namespace DFG_ROOT_NS;
+            if (!bench::perfCountersRequestedByEnvironment())
+                return 0;
+            if (!bench::PerfCounters().anyAvailable())
+                std::cout << "Note: hardware performance counters are not available, counter columns will be empty\n";
+            m_nFirstPerfCounterColumn = nFirstColumn;
+            for (uint32 i = 0; i < bench::perfCounterCount; ++i)
+                this->addString(SzPtrUtf8(bench::perfCounterColumnName(static_cast<bench::PerfCounterId>(i))), 0, nFirstColumn + i);
+            return static_cast<uint32>(bench::perfCounterCount);
+        }
+
+        bool hasPerfCounterColumns() const { return m_nFirstPerfCounterColumn != DFG_ROOT_NS::NumericTraits<uint32>::maxValue; }
+
+        // Sets counter values normalized by nOpCount to given row; values of the latest iteration are kept.
+        void setPerfCounterValues(const uint32 nRow, const bench::PerfCounterValues& values, const double nOpCount)
+        {
+            using namespace DFG_ROOT_NS;
+            using namespace DFG_MODULE_NS(str);
+            if (!hasPerfCounterColumns())
+                return;
+            for (uint32 i = 0; i < bench::perfCounterCount; ++i)
+            {
+                const auto id = static_cast<bench::PerfCounterId>(i);
+                if (!values.isAvailable(id))
+                    continue;
+                char sz[32];
+                this->setElement(nRow, m_nFirstPerfCounterColumn + i, SzPtrUtf8(toStr(values.perOperation(id, nOpCount), sz, 6)));
+            }
+        }
+
+    private:
+        // Stores values of row r in result columns [firstResultCol, nColEnd) to vals skipping warmup columns.
+        void measuredValues(const uint32 r, const uint32 firstResultCol, const uint32 nColEnd, DFG_MODULE_NS(cont)::ValueVector<double>& vals)
+        {
+            vals.clear();
+            for (uint32 c = firstResultCol; c < nColEnd; ++c)
+            {
+                auto pHeader = (*this)(0, c);
+                if (!pHeader || std::strncmp(pHeader.rawPtr(), "Warmup#", 7) == 0)
+                    continue;
+                auto p = (*this)(r, c);
+                if (!p)
+                    continue;
+                vals.push_back(DFG_MODULE_NS(str)::strTo<double>(p.rawPtr()));
+            }
+        }
+
+        uint32 m_nFirstPerfCounterColumn = DFG_ROOT_NS::NumericTraits<uint32>::maxValue;
     };
 
     std::string generateCompilerInfoForOutputFilename()
@@ -146,6 +240,8 @@ Cont_T VectorInsertImpl(Generator_T generator, InsertPosGenerator_T indexGenerat
     using namespace DFG_MODULE_NS(str);
 
     Cont_T cont;
+    bench::PerfCounters perfCounters(pTable && pTable->hasPerfCounterColumns());
+    perfCounters.start();
     DFG_MODULE_NS(time)::TimerCpu timer;
     cont.reserve(nCount);
     cont.push_back(generator(1));
@@ -155,6 +251,9 @@ Cont_T VectorInsertImpl(Generator_T generator, InsertPosGenerator_T indexGenerat
         cont.insert(cont.begin() + nPos, generator(nPos));
     }
     const auto elapsedTime = timer.elapsedWallSeconds();
+    const auto perfCounterValues = perfCounters.stop();
+    if (pTable)
+        pTable->setPerfCounterValues(nRow, perfCounterValues, nCount);
     //const auto sReservationInfo = (capacity != NumericTraits<size_t>::maxValue) ? format_fmt(", reserved: {}", int(capacity >= cont.size())) : "";
     if (pTable)
         pTable->addString(floatingPointToStr<StringUtf8>(elapsedTime, 4 /*number of significant digits*/), nRow, pTable->colCountByMaxColIndex() - 1);
@@ -208,23 +307,38 @@ void VectorInsertImpl(const int nCount, BenchmarkResultTable* pTable = nullptr,
         pTable->addString(SzPtrUtf8(containerDescription(std::vector<T>()).c_str()), nRow, nTypeCol);
         pTable->addString(SzPtrUtf8(containerDescription(boost::container::vector<T>()).c_str()), nRow + 1, nTypeCol);
         pTable->addString(SzPtrUtf8(containerDescription(DFG_MODULE_NS(cont)::Vector<T>()).c_str()), nRow + 2, nTypeCol);
+        pTable->addString(SzPtrUtf8(containerDescription(bench::TieredVector<T>()).c_str()), nRow + 3, nTypeCol);
+        pTable->addString(SzPtrUtf8(containerDescription(bench::RelocatingVector<T>()).c_str()), nRow + 4, nTypeCol);
     }
 
 #if 1 // If true, using file-based insert positions.
+    // Binary trace (see traceConvert/traceConvert.cpp) is preferred over text file: it's memory-mapped and positions are read
+    // from the mapping in place. Either way positions are ready before timing starts.
     std::vector<int> contInsertIndexes;
-    contInsertIndexes.reserve(50000);
-    std::ifstream istrm("testfiles/vectorInsertIndexes_50000.txt");
+    std::optional<bench::TraceView> insertTrace;
+    if (std::ifstream("testfiles/vectorInsertIndexes_50000.trace"))
+    {
+        insertTrace.emplace("testfiles/vectorInsertIndexes_50000.trace");
+        ASSERT_EQ(insertTrace->size(), insertTrace->countOf(bench::TraceOp::insertAt));
+        insertTrace->prefault();
+    }
+    else
     {
+        contInsertIndexes.reserve(50000);
+        std::ifstream istrm("testfiles/vectorInsertIndexes_50000.txt");
         int i;
         while (istrm >> i)
         {
             contInsertIndexes.push_back(i);
         }
     }
+    const size_t nInsertIndexCount = (insertTrace) ? insertTrace->size() : contInsertIndexes.size();
+    ASSERT_GT(nInsertIndexCount, 0u);
 
     const auto indexGenerator = [&](const size_t nContSize)
                                 {
-                                    return contInsertIndexes[(nContSize - 1) % contInsertIndexes.size()];
+                                    const auto nIndex = (nContSize - 1) % nInsertIndexCount;
+                                    return (insertTrace) ? static_cast<int>((*insertTrace)[nIndex].m_nPosition) : contInsertIndexes[nIndex];
                                 };
 #else // Case: using random generator based insert positions.
     const unsigned long nRandEngSeed = 12345678;
@@ -241,12 +355,18 @@ void VectorInsertImpl(const int nCount, BenchmarkResultTable* pTable = nullptr,
     const auto stdVec = VectorInsertImpl<std::vector<T>>(generate<T>, indexGenerator, nCount, pTable, nRow);
     const auto boostVec = VectorInsertImpl<boost::container::vector<T>>(generate<T>, indexGenerator, nCount, pTable, nRow + 1);
     const auto dfgVec = VectorInsertImpl<DFG_MODULE_NS(cont)::Vector<T>>(generate<T>, indexGenerator, nCount, pTable, nRow + 2);
+    const auto tieredVec = VectorInsertImpl<bench::TieredVector<T>>(generate<T>, indexGenerator, nCount, pTable, nRow + 3);
+    const auto relocatingVec = VectorInsertImpl<bench::RelocatingVector<T>>(generate<T>, indexGenerator, nCount, pTable, nRow + 4);
     ASSERT_EQ(nCount, stdVec.size());
     ASSERT_EQ(stdVec.size(), boostVec.size());
     ASSERT_EQ(stdVec.size(), dfgVec.size());
+    ASSERT_EQ(stdVec.size(), tieredVec.size());
+    ASSERT_EQ(stdVec.size(), relocatingVec.size());
 
     EXPECT_TRUE(std::equal(stdVec.begin(), stdVec.end(), boostVec.begin()));
     EXPECT_TRUE(std::equal(stdVec.begin(), stdVec.end(), dfgVec.begin()));
+    EXPECT_TRUE(std::equal(stdVec.begin(), stdVec.end(), tieredVec.begin()));
+    EXPECT_TRUE(std::equal(stdVec.begin(), stdVec.end(), relocatingVec.begin()));
     
     if (pTable)
     {
@@ -305,14 +425,15 @@ TEST(dfgCont, VectorInsertPerformance)
     table.addString(SzPtrUtf8("Build type"), 0, 4);
     table.addString(DFG_UTF8("Insert count"), 0, 5);
     table.addString(SzPtrUtf8("Test type"), 0, 6);
-    const auto nLastStaticColumn = 6;
+    const auto nTypeColumn = 6;
+    const auto nLastStaticColumn = nTypeColumn + table.addPerfCounterColumns(nTypeColumn + 1);
 
     const auto nElementTypeCount = 4;
-    const auto nContainerCount = 3;
+    const auto nContainerCount = 5;
 
-    for (size_t i = 0; i < 5; ++i) // Iterations.
+    for (bench::RepetitionController repetitions(bench::repetitionPolicyFromEnvironment()); !repetitions.done(); repetitions.advance(table.maxRelativeCiHalfWidth(nLastStaticColumn + 1)))
     {
-        if (i == 0)
+        if (repetitions.iterationIndex() == 0)
         {
             const StringUtf8 sTime(SzPtrUtf8(DFG_MODULE_NS(time)::localDate_yyyy_mm_dd_C().c_str()));
             const auto sCompiler = SzPtrUtf8(DFG_COMPILER_NAME_SIMPLE);
@@ -333,11 +454,11 @@ TEST(dfgCont, VectorInsertPerformance)
             }
         }
 
-        table.addString(SzPtrUtf8(("Time#" + toStrC(i)).c_str()), 0, table.colCountByMaxColIndex());
-        VectorInsertImpl<int>(nCount, &table, 1, nLastStaticColumn);
-        VectorInsertImpl<double>(nCount, &table, 1 + 1 * nContainerCount, nLastStaticColumn);
-        VectorInsertImpl<std::pair<int, int>>(nCount, &table, 1 + 2 * nContainerCount, nLastStaticColumn);
-        VectorInsertImpl<DFG_MODULE_NS(cont)::TrivialPair<int, int>>(nCount, &table, 1 + 3 * nContainerCount, nLastStaticColumn);
+        table.addString(SzPtrUtf8(repetitions.iterationLabel("Time").c_str()), 0, table.colCountByMaxColIndex());
+        VectorInsertImpl<int>(nCount, &table, 1, nTypeColumn);
+        VectorInsertImpl<double>(nCount, &table, 1 + 1 * nContainerCount, nTypeColumn);
+        VectorInsertImpl<std::pair<int, int>>(nCount, &table, 1 + 2 * nContainerCount, nTypeColumn);
+        VectorInsertImpl<DFG_MODULE_NS(cont)::TrivialPair<int, int>>(nCount, &table, 1 + 3 * nContainerCount, nTypeColumn);
     }
 
     // Calculate averages etc.